@@ -0,0 +1,9 @@
+# File for module specific CMake tests.
+
+# The generic local finite elements construct their coefficients on the
+# ConstructionThreadPool, which uses std::thread. Register the thread
+# library for all targets of this module and of the modules depending on it.
+find_package(Threads)
+if(CMAKE_THREAD_LIBS_INIT)
+  dune_register_package_flags(LIBRARIES "${CMAKE_THREAD_LIBS_INIT}")
+endif()
@@ -0,0 +1,294 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/function.hh>
+#include <dune/common/typeutilities.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1cube2d.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1cube3d.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1simplex2d.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini2cube2d.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini2simplex2d.hh>
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/pk.hh>
+#include <dune/localfunctions/lagrange/prismp1.hh>
+#include <dune/localfunctions/lagrange/prismp2.hh>
+#include <dune/localfunctions/lagrange/pyramidp1.hh>
+#include <dune/localfunctions/lagrange/pyramidp2.hh>
+#include <dune/localfunctions/lagrange/qk.hh>
+#include <dune/localfunctions/monomial.hh>
+#include <dune/localfunctions/orthonormal.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomascube.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomassimplex.hh>
+
+#include "benchmark.hh"
+
+/** \file
+ * \brief Measure the throughput of local finite element operations
+ *
+ * For every element, evaluateFunction, evaluateJacobian and (where
+ * available) first-order partial derivatives are timed at the points of a
+ * quadrature rule of twice the polynomial order. In addition, the
+ * interpolation of a smooth function is timed. The results are reported
+ * in nanoseconds per point and per point and degree of freedom.
+ *
+ * Usage:
+ * \code
+ * benchmark-localfunctions [--min-time <seconds>] [--filter <substring>] [--json <file>]
+ * \endcode
+ */
+
+using Dune::Benchmark::Runner;
+
+// Function interpolated by the elements
+template<class DomainType, class RangeType>
+class Gaussian
+  : public Dune::Function<const DomainType&, RangeType&>
+{
+public:
+  void evaluate (const DomainType& x, RangeType& y) const
+  {
+    DomainType c(0.5);
+    c -= x;
+    y = std::exp(-3.0*c.two_norm2());
+  }
+};
+
+// Time first-order partial derivatives in the first direction, if the basis provides them
+template<class LB, class Points>
+auto benchmarkPartial (Runner& runner, const LB& basis, const Points& points,
+                       const std::string& name, const std::string& geometry, Dune::PriorityTag<1>)
+  -> decltype(basis.partial(std::declval<std::array<unsigned int,LB::Traits::dimDomain> >(),
+                            points[0],
+                            std::declval<std::vector<typename LB::Traits::RangeType>&>()))
+{
+  std::array<unsigned int,LB::Traits::dimDomain> direction;
+  direction.fill(0);
+  direction[0] = 1;
+
+  std::vector<typename LB::Traits::RangeType> partials;
+  runner.run(name, geometry, "partial", basis.size(), points.size(), [&]() {
+      double sum = 0;
+      for (const auto& x : points)
+      {
+        basis.partial(direction, x, partials);
+        sum += partials[0][0];
+      }
+      return sum;
+    });
+}
+
+template<class LB, class Points>
+void benchmarkPartial (Runner&, const LB&, const Points&,
+                       const std::string&, const std::string&, Dune::PriorityTag<0>)
+{}
+
+template<class FE>
+void benchmarkElement (Runner& runner, const FE& fe, const std::string& name)
+{
+  typedef typename FE::Traits::LocalBasisType LB;
+  typedef typename LB::Traits Traits;
+  typedef typename Traits::DomainFieldType DF;
+  const int dim = Traits::dimDomain;
+
+  const LB& basis = fe.localBasis();
+  const std::size_t dofs = basis.size();
+
+  std::ostringstream geometry;
+  geometry << fe.type();
+
+  const auto& quad = Dune::QuadratureRules<DF,dim>::rule(fe.type(), 2*basis.order());
+  std::vector<typename Traits::DomainType> points;
+  for (const auto& qp : quad)
+    points.push_back(qp.position());
+
+  std::vector<typename Traits::RangeType> values;
+  runner.run(name, geometry.str(), "evaluateFunction", dofs, points.size(), [&]() {
+      double sum = 0;
+      for (const auto& x : points)
+      {
+        basis.evaluateFunction(x, values);
+        sum += values[0][0];
+      }
+      return sum;
+    });
+
+  std::vector<typename Traits::JacobianType> jacobians;
+  runner.run(name, geometry.str(), "evaluateJacobian", dofs, points.size(), [&]() {
+      double sum = 0;
+      for (const auto& x : points)
+      {
+        basis.evaluateJacobian(x, jacobians);
+        sum += jacobians[0][0][0];
+      }
+      return sum;
+    });
+
+  benchmarkPartial(runner, basis, points, name, geometry.str(), Dune::PriorityTag<1>());
+
+  Gaussian<typename Traits::DomainType,typename Traits::RangeType> f;
+  std::vector<typename Traits::RangeFieldType> coefficients;
+  runner.run(name, geometry.str(), "interpolate", dofs, 0, [&]() {
+      fe.localInterpolation().interpolate(f, coefficients);
+      return double(coefficients[0]);
+    });
+}
+
+// Construct the element only if it is selected
+template<class FE, class... Args>
+void benchmark (Runner& runner, const std::string& name, Args&&... args)
+{
+  if (not runner.enabled(name))
+    return;
+  const FE fe(std::forward<Args>(args)...);
+  benchmarkElement(runner, fe, name);
+}
+
+std::string label (const std::string& family, int dim, int order)
+{
+  return family + " " + std::to_string(dim) + "d k=" + std::to_string(order);
+}
+
+template<int d, std::size_t... k>
+void benchmarkPk (Runner& runner, std::index_sequence<k...>)
+{
+  std::initializer_list<int>{
+    (benchmark<Dune::PkLocalFiniteElement<double,double,d,k+1> >(runner, label("Pk", d, k+1)), 0)...
+  };
+}
+
+template<int d, std::size_t... k>
+void benchmarkQk (Runner& runner, std::index_sequence<k...>)
+{
+  std::initializer_list<int>{
+    (benchmark<Dune::QkLocalFiniteElement<double,double,d,k+1> >(runner, label("Qk", d, k+1)), 0)...
+  };
+}
+
+template<int d, std::size_t... k>
+void benchmarkMonomial (Runner& runner, const Dune::GeometryType& gt, std::index_sequence<k...>)
+{
+  std::initializer_list<int>{
+    (benchmark<Dune::MonomialLocalFiniteElement<double,double,d,k+1> >(runner, label("Monomial", d, k+1), gt), 0)...
+  };
+}
+
+template<int d>
+void benchmarkGeneric (Runner& runner, int maxOrder)
+{
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,d,double,double> Lagrange;
+  typedef Dune::OrthonormalLocalFiniteElement<d,double,double> Orthonormal;
+
+  Dune::GeometryType simplex, cube;
+  simplex.makeSimplex(d);
+  cube.makeCube(d);
+  for (int k=1; k<=maxOrder; ++k)
+  {
+    benchmark<Lagrange>(runner, label("Lagrange simplex", d, k), simplex, k);
+    benchmark<Lagrange>(runner, label("Lagrange cube", d, k), cube, k);
+    benchmark<Orthonormal>(runner, label("Orthonormal simplex", d, k), simplex, k);
+  }
+}
+
+int main (int argc, char** argv) try
+{
+  double minTime = 0.05;
+  std::string filter;
+  std::string jsonFile;
+  for (int i=1; i<argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--min-time" and i+1 < argc)
+      minTime = std::atof(argv[++i]);
+    else if (arg == "--filter" and i+1 < argc)
+      filter = argv[++i];
+    else if (arg == "--json" and i+1 < argc)
+      jsonFile = argv[++i];
+    else
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " [--min-time <seconds>] [--filter <substring>] [--json <file>]" << std::endl;
+      return 1;
+    }
+  }
+
+  Runner runner(minTime, filter);
+
+  // Lagrange elements
+  benchmarkPk<1>(runner, std::make_index_sequence<4>());
+  benchmarkPk<2>(runner, std::make_index_sequence<4>());
+  benchmarkPk<3>(runner, std::make_index_sequence<4>());
+  benchmarkQk<1>(runner, std::make_index_sequence<6>());
+  benchmarkQk<2>(runner, std::make_index_sequence<6>());
+  benchmarkQk<3>(runner, std::make_index_sequence<6>());
+  benchmark<Dune::PrismP1LocalFiniteElement<double,double> >(runner, "PrismP1");
+  benchmark<Dune::PrismP2LocalFiniteElement<double,double> >(runner, "PrismP2");
+  benchmark<Dune::PyramidP1LocalFiniteElement<double,double> >(runner, "PyramidP1");
+  benchmark<Dune::PyramidP2LocalFiniteElement<double,double> >(runner, "PyramidP2");
+
+  // H(div) elements
+  Dune::GeometryType triangle;
+  triangle.makeTriangle();
+  benchmark<Dune::RaviartThomasSimplexLocalFiniteElement<2,double,double> >(runner, label("RaviartThomas simplex", 2, 0), triangle, 0);
+  benchmark<Dune::RaviartThomasSimplexLocalFiniteElement<2,double,double> >(runner, label("RaviartThomas simplex", 2, 1), triangle, 1);
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,2,0> >(runner, label("RaviartThomas cube", 2, 0));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,2,1> >(runner, label("RaviartThomas cube", 2, 1));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,2,2> >(runner, label("RaviartThomas cube", 2, 2));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,2,3> >(runner, label("RaviartThomas cube", 2, 3));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,2,4> >(runner, label("RaviartThomas cube", 2, 4));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,3,0> >(runner, label("RaviartThomas cube", 3, 0));
+  benchmark<Dune::RaviartThomasCubeLocalFiniteElement<double,double,3,1> >(runner, label("RaviartThomas cube", 3, 1));
+  benchmark<Dune::BDM1Simplex2DLocalFiniteElement<double,double> >(runner, "BDM1Simplex2D");
+  benchmark<Dune::BDM2Simplex2DLocalFiniteElement<double,double> >(runner, "BDM2Simplex2D");
+  benchmark<Dune::BDM1Cube2DLocalFiniteElement<double,double> >(runner, "BDM1Cube2D");
+  benchmark<Dune::BDM2Cube2DLocalFiniteElement<double,double> >(runner, "BDM2Cube2D");
+  benchmark<Dune::BDM1Cube3DLocalFiniteElement<double,double> >(runner, "BDM1Cube3D");
+
+  // Discontinuous elements
+  Dune::GeometryType quadrilateral, hexahedron;
+  quadrilateral.makeQuadrilateral();
+  hexahedron.makeHexahedron();
+  benchmarkMonomial<2>(runner, quadrilateral, std::make_index_sequence<4>());
+  benchmarkMonomial<3>(runner, hexahedron, std::make_index_sequence<4>());
+
+  // Generic elements
+  benchmarkGeneric<2>(runner, 4);
+  benchmarkGeneric<3>(runner, 4);
+
+  runner.printTable(std::cout);
+
+  if (not jsonFile.empty())
+  {
+    std::ofstream json(jsonFile);
+    if (not json)
+      DUNE_THROW(Dune::IOError, "Could not open " << jsonFile << " for writing");
+    runner.writeJSON(json);
+  }
+
+  return 0;
+}
+catch (const Dune::Exception& e)
+{
+  std::cerr << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,190 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_BENCHMARK_BENCHMARK_HH
+#define DUNE_LOCALFUNCTIONS_BENCHMARK_BENCHMARK_HH
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+/** \file
+ * \brief A small self-contained harness for timing local finite element operations
+ */
+
+namespace Dune
+{
+  namespace Benchmark
+  {
+
+    /** \brief Timing of one operation of one finite element
+     *
+     * One call is a sweep over all points, or a single interpolation if
+     * the operation is not evaluated at points.
+     */
+    struct Result
+    {
+      std::string element;
+      std::string geometry;
+      std::string operation;
+      std::size_t dofs;
+      std::size_t points;
+      std::size_t repetitions;
+      double nsPerCall;
+
+      //! Time per evaluation point, or per call if the operation has no points
+      double nsPerPoint () const
+      {
+        return points > 0 ? nsPerCall/points : nsPerCall;
+      }
+
+      //! Time per evaluation point and degree of freedom
+      double nsPerDof () const
+      {
+        return dofs > 0 ? nsPerPoint()/dofs : nsPerPoint();
+      }
+    };
+
+    /** \brief Runs timed operations and collects the results
+     *
+     * Each operation is a callable that performs one call and returns a
+     * double computed from its output, so that the compiler cannot drop
+     * the work. The number of repetitions is doubled until one batch takes
+     * at least the minimal time; the time of this last batch is reported.
+     * Operations that throw Dune::NotImplemented are not reported.
+     */
+    class Runner
+    {
+      typedef std::chrono::steady_clock Clock;
+
+    public:
+      /** \brief Constructor
+       *
+       * \param minTime Minimal time in seconds spent in each timed batch
+       * \param filter Only run elements whose name contains this string
+       */
+      Runner (double minTime, const std::string& filter = "")
+        : minTime_(minTime), filter_(filter), sink_(0)
+      {}
+
+      //! Whether the element with the given name is selected by the filter
+      bool enabled (const std::string& element) const
+      {
+        return filter_.empty() or element.find(filter_) != std::string::npos;
+      }
+
+      /** \brief Time an operation
+       *
+       * \param points Number of points evaluated in one call, 0 if the operation has no points
+       */
+      template<class Operation>
+      void run (const std::string& element, const std::string& geometry, const std::string& operation,
+                std::size_t dofs, std::size_t points, Operation&& call)
+      {
+        // warm up caches and lazily built data; some elements implement
+        // an operation only partially, these are skipped
+        try {
+          sink_ += call();
+        }
+        catch (const Dune::NotImplemented&) {
+          return;
+        }
+
+        std::size_t repetitions = 1;
+        double seconds = 0;
+        while (true)
+        {
+          const auto start = Clock::now();
+          for (std::size_t r=0; r<repetitions; ++r)
+            sink_ += call();
+          seconds = std::chrono::duration<double>(Clock::now() - start).count();
+          if (seconds >= minTime_)
+            break;
+          repetitions *= 2;
+        }
+
+        results_.push_back({element, geometry, operation, dofs, points, repetitions,
+                            1e9*seconds/repetitions});
+      }
+
+      const std::vector<Result>& results () const
+      {
+        return results_;
+      }
+
+      //! Print the results as a table
+      void printTable (std::ostream& out) const
+      {
+        out << std::left << std::setw(36) << "element"
+            << std::setw(20) << "operation"
+            << std::right << std::setw(8) << "dofs"
+            << std::setw(8) << "points"
+            << std::setw(14) << "ns/point"
+            << std::setw(12) << "ns/dof" << "\n";
+        for (const auto& r : results_)
+          out << std::left << std::setw(36) << r.element
+              << std::setw(20) << r.operation
+              << std::right << std::setw(8) << r.dofs
+              << std::setw(8) << r.points
+              << std::fixed << std::setprecision(2)
+              << std::setw(14) << r.nsPerPoint()
+              << std::setw(12) << r.nsPerDof() << "\n";
+        out.unsetf(std::ios_base::floatfield);
+      }
+
+      //! Write the results as a JSON document
+      void writeJSON (std::ostream& out) const
+      {
+        out << "{\n  \"benchmarks\": [";
+        for (std::size_t i=0; i<results_.size(); ++i)
+        {
+          const Result& r = results_[i];
+          out << (i>0 ? "," : "") << "\n    {"
+              << "\"element\": " << quote(r.element)
+              << ", \"geometry\": " << quote(r.geometry)
+              << ", \"operation\": " << quote(r.operation)
+              << ", \"dofs\": " << r.dofs
+              << ", \"points\": " << r.points
+              << ", \"repetitions\": " << r.repetitions
+              << std::setprecision(6)
+              << ", \"ns_per_call\": " << r.nsPerCall
+              << ", \"ns_per_point\": " << r.nsPerPoint()
+              << ", \"ns_per_dof\": " << r.nsPerDof()
+              << "}";
+        }
+        out << "\n  ],\n  \"min_time\": " << minTime_
+            << ",\n  \"checksum\": " << (std::isfinite(sink_) ? sink_ : 0.0) << "\n}\n";
+      }
+
+    private:
+      static std::string quote (const std::string& s)
+      {
+        std::ostringstream out;
+        out << '"';
+        for (char c : s)
+        {
+          if (c == '"' or c == '\\')
+            out << '\\';
+          out << c;
+        }
+        out << '"';
+        return out.str();
+      }
+
+      double minTime_;
+      std::string filter_;
+      std::vector<Result> results_;
+      double sink_;
+    };
+
+  } // namespace Benchmark
+
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_BENCHMARK_BENCHMARK_HH
@@ -0,0 +1,113 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_COMMON_CONCURRENTCACHE_HH
+#define DUNE_LOCALFUNCTIONS_COMMON_CONCURRENTCACHE_HH
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/type.hh>
+
+namespace Dune
+{
+
+  /** \brief A cache of local finite elements, one per GeometryType, that can be shared by several threads
+   *
+   * The elements are stored in a fixed array indexed by the topology id of
+   * the GeometryType, normalized like in the topology code, i.e., without
+   * its lowest bit, which does not distinguish topologies. Each entry is created on first request and published
+   * atomically. Later lookups of the same GeometryType only read an atomic
+   * pointer and never take a lock, so the cache can be used from all threads
+   * of an assembler without any external synchronization. The creation of
+   * missing entries is serialized by a mutex.
+   *
+   * \tparam FE Type of the stored finite elements
+   * \tparam Factory Class providing a static method
+   *         <tt>FE* create(const GeometryType&)</tt> that returns
+   *         a new finite element or 0 if none is available
+   * \tparam dim Element dimension
+   */
+  template<class FE, class Factory, int dim>
+  class ConcurrentLocalFiniteElementCache
+  {
+    // one slot per topology of the given dimension, and one for the 'none' type
+    static const std::size_t numSlots = (dim > 0 ? std::size_t(1) << (dim-1) : 1) + 1;
+
+  public:
+    /** \brief Type of the finite elements stored in this cache */
+    typedef FE FiniteElementType;
+
+    /** \brief Default constructor */
+    ConcurrentLocalFiniteElementCache()
+    {
+      for (auto& slot : slots_)
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+
+    /** \brief Copy constructor
+     *
+     * Clones all elements that have been published in the other cache.
+     */
+    ConcurrentLocalFiniteElementCache(const ConcurrentLocalFiniteElementCache& other)
+    {
+      for (std::size_t i=0; i<numSlots; ++i)
+      {
+        const FE* fe = other.slots_[i].load(std::memory_order_acquire);
+        slots_[i].store(fe ? fe->clone() : nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    ConcurrentLocalFiniteElementCache& operator=(const ConcurrentLocalFiniteElementCache&) = delete;
+
+    ~ConcurrentLocalFiniteElementCache()
+    {
+      for (auto& slot : slots_)
+        delete slot.load(std::memory_order_relaxed);
+    }
+
+    //! Get local finite element for given GeometryType
+    const FiniteElementType& get(const GeometryType& gt) const
+    {
+      const std::size_t i = index(gt);
+      const FE* fe = slots_[i].load(std::memory_order_acquire);
+      if (fe)
+        return *fe;
+      return create(i, gt);
+    }
+
+  private:
+    static std::size_t index(const GeometryType& gt)
+    {
+      if (gt.dim() != dim)
+        DUNE_THROW(Dune::RangeError, "GeometryType " << gt << " does not have dimension " << dim);
+      // equivalent topology ids differ in the lowest bit only
+      return gt.isNone() ? numSlots-1 : (gt.id() >> 1);
+    }
+
+    // slow path: create the element while holding the lock, unless another
+    // thread has published it in the meantime
+    const FiniteElementType& create(std::size_t i, const GeometryType& gt) const
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      const FE* fe = slots_[i].load(std::memory_order_relaxed);
+      if (not fe)
+      {
+        fe = Factory::create(gt);
+        if (fe==0)
+          DUNE_THROW(Dune::NotImplemented, "No local finite element available for geometry type " << gt);
+        slots_[i].store(fe, std::memory_order_release);
+      }
+      return *fe;
+    }
+
+    mutable std::array<std::atomic<const FE*>,numSlots> slots_;
+    mutable std::mutex mutex_;
+  };
+
+}
+
+#endif
@@ -3,10 +3,16 @@
 #ifndef DUNE_LOCALBASIS_HH
 #define DUNE_LOCALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <iostream>
 #include <vector>
 
+#include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
+#include <dune/common/typeutilities.hh>
 
 namespace Dune
 {
@@ -68,6 +74,14 @@ namespace Dune
      */
     typedef J JacobianType;
 
+    /** \brief Type to represent the second derivatives
+
+            HessianType is an array of m matrices of n x n components where
+            entry H[i][j][k] contains the derivative
+            \f$\partial_j \partial_k \hat\phi_i \f$.
+     */
+    typedef std::array<FieldMatrix<RF,n,n>,m> HessianType;
+
     //! \brief Enum for differentiability order
     enum {
       //! \brief number of partial derivatives supported
@@ -175,5 +189,197 @@ namespace Dune
     };
   };
 
+
+  namespace Impl
+  {
+
+    // Scratch vector of the calling thread for intermediate results of an
+    // evaluation whose size is only known at run time.  Reusing it saves
+    // the heap allocation of a local vector on every call.  The price is
+    // that there is one vector per thread and combination of User and T,
+    // which lives until the thread exits and keeps the largest capacity it
+    // ever needed.  The User, i.e. the class asking for the buffer, keeps
+    // nested evaluations, e.g. of a PowerBasis of a PowerBasis, from
+    // sharing a buffer.  Callers must not keep a reference beyond the call.
+    template<class User, class T>
+    std::vector<T>& threadScratch ()
+    {
+      thread_local std::vector<T> scratch;
+      return scratch;
+    }
+
+    // Prepare the output container of an evaluation for n entries.
+    // Resizable containers like std::vector or ReservedVector are resized,
+    // containers of fixed size like std::array have to be large enough.
+    template<class Container>
+    auto resizeOutput (Container& out, std::size_t n, PriorityTag<1>)
+      -> decltype(out.resize(n))
+    {
+      out.resize(n);
+    }
+
+    template<class Container>
+    void resizeOutput (Container& out, std::size_t n, PriorityTag<0>)
+    {
+      assert(out.size() >= n);
+    }
+
+    template<class Container>
+    void resizeOutput (Container& out, std::size_t n)
+    {
+      resizeOutput(out, n, PriorityTag<42>());
+    }
+
+    // Use the batched evaluation of the local basis if it provides one
+    template<class LocalBasis, class Points, class Range>
+    auto evaluateFunctionBatch (const LocalBasis& basis, const Points& points,
+                                std::vector<Range>& out, PriorityTag<1>)
+      -> decltype(basis.evaluateFunctionBatch(points, out))
+    {
+      basis.evaluateFunctionBatch(points, out);
+    }
+
+    // Otherwise evaluate point by point, reusing a single buffer
+    template<class LocalBasis, class Points, class Range>
+    void evaluateFunctionBatch (const LocalBasis& basis, const Points& points,
+                                std::vector<Range>& out, PriorityTag<0>)
+    {
+      const std::size_t size = basis.size();
+      out.resize(points.size()*size);
+      std::vector<Range> values;
+      for (std::size_t q=0; q<points.size(); q++)
+      {
+        basis.evaluateFunction(points[q], values);
+        std::copy(values.begin(), values.end(), out.begin()+q*size);
+      }
+    }
+
+    template<class LocalBasis, class Points, class Jacobian>
+    auto evaluateJacobianBatch (const LocalBasis& basis, const Points& points,
+                                std::vector<Jacobian>& out, PriorityTag<1>)
+      -> decltype(basis.evaluateJacobianBatch(points, out))
+    {
+      basis.evaluateJacobianBatch(points, out);
+    }
+
+    template<class LocalBasis, class Points, class Jacobian>
+    void evaluateJacobianBatch (const LocalBasis& basis, const Points& points,
+                                std::vector<Jacobian>& out, PriorityTag<0>)
+    {
+      const std::size_t size = basis.size();
+      out.resize(points.size()*size);
+      std::vector<Jacobian> values;
+      for (std::size_t q=0; q<points.size(); q++)
+      {
+        basis.evaluateJacobian(points[q], values);
+        std::copy(values.begin(), values.end(), out.begin()+q*size);
+      }
+    }
+
+    // Use the evaluation of all second derivatives of the local basis if it provides one
+    template<class LocalBasis, class Out>
+    auto evaluateHessian (const LocalBasis& basis, const typename LocalBasis::Traits::DomainType& x,
+                          Out& out, PriorityTag<1>)
+      -> decltype(basis.evaluateHessian(x, out))
+    {
+      basis.evaluateHessian(x, out);
+    }
+
+    // Otherwise assemble the Hessians from the partial derivatives of order two
+    template<class LocalBasis, class Out>
+    void evaluateHessian (const LocalBasis& basis, const typename LocalBasis::Traits::DomainType& x,
+                          Out& out, PriorityTag<0>)
+    {
+      typedef typename LocalBasis::Traits Traits;
+      const std::size_t size = basis.size();
+      resizeOutput(out, size);
+      std::vector<typename Traits::RangeType> partials;
+      std::array<unsigned int,Traits::dimDomain> order;
+      for (int a=0; a<Traits::dimDomain; a++)
+        for (int b=a; b<Traits::dimDomain; b++)
+        {
+          order.fill(0);
+          ++order[a];
+          ++order[b];
+          basis.partial(order, x, partials);
+          for (std::size_t i=0; i<size; i++)
+            for (int m=0; m<Traits::dimRange; m++)
+            {
+              out[i][m][a][b] = partials[i][m];
+              out[i][m][b][a] = partials[i][m];
+            }
+        }
+    }
+
+  } // end namespace Impl
+
+
+  /**@ingroup LocalBasisInterface
+         \brief Evaluate all shape functions of a local basis at a set of points
+
+         The result is stored point by point in one contiguous vector, i.e.,
+         out[q*basis.size()+i] is the value of shape function i at points[q].
+
+         Local bases may implement a member function
+         evaluateFunctionBatch(points, out) with the same semantics to
+         provide an optimized implementation.  For all other bases the
+         points are evaluated one by one using evaluateFunction.
+
+         \param basis The local basis to evaluate
+         \param points Random access container of positions in the reference element
+         \param[out] out Values of all shape functions at all points
+   */
+  template<class LocalBasis, class Points>
+  void evaluateFunctionBatch (const LocalBasis& basis, const Points& points,
+                              std::vector<typename LocalBasis::Traits::RangeType>& out)
+  {
+    Impl::evaluateFunctionBatch(basis, points, out, PriorityTag<42>());
+  }
+
+  /**@ingroup LocalBasisInterface
+         \brief Evaluate the Jacobians of all shape functions of a local basis at a set of points
+
+         The result is stored point by point in one contiguous vector, i.e.,
+         out[q*basis.size()+i] is the Jacobian of shape function i at points[q].
+
+         Local bases may implement a member function
+         evaluateJacobianBatch(points, out) with the same semantics to
+         provide an optimized implementation.
+
+         \param basis The local basis to evaluate
+         \param points Random access container of positions in the reference element
+         \param[out] out Jacobians of all shape functions at all points
+   */
+  template<class LocalBasis, class Points>
+  void evaluateJacobianBatch (const LocalBasis& basis, const Points& points,
+                              std::vector<typename LocalBasis::Traits::JacobianType>& out)
+  {
+    Impl::evaluateJacobianBatch(basis, points, out, PriorityTag<42>());
+  }
+
+  /**@ingroup LocalBasisInterface
+         \brief Evaluate the second derivatives of all shape functions of a local basis
+
+         out[i][m] is the Hessian of component m of shape function i at x,
+         see LocalBasisTraits::HessianType.
+
+         Local bases may implement a member function evaluateHessian(x, out)
+         with the same semantics, which computes all second derivatives in
+         one pass.  For all other bases the Hessians are assembled from
+         dim(dim+1)/2 calls to partial().
+
+         \param basis The local basis to evaluate
+         \param x Position in the reference element
+         \param[out] out Hessians of all shape functions, a resizable
+                    container or one of fixed size at least basis.size()
+   */
+  template<class LocalBasis, class Out>
+  void evaluateHessian (const LocalBasis& basis,
+                        const typename LocalBasis::Traits::DomainType& x,
+                        Out& out)
+  {
+    Impl::evaluateHessian(basis, x, out, PriorityTag<42>());
+  }
+
 }
 #endif
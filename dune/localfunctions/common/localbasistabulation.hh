@@ -0,0 +1,377 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALBASISTABULATION_HH
+#define DUNE_LOCALBASISTABULATION_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+
+namespace Dune
+{
+
+  /** \brief Values, Jacobians and optionally Hessians of a local basis,
+   *         precomputed at the points of a quadrature rule
+   *
+   * All data is stored in a single contiguous block of memory whose
+   * sections (values, Jacobians, Hessians) are aligned to cache lines.
+   * Within each section the data is stored point-major, i.e., the entries
+   * of all shape functions at one quadrature point are contiguous and can
+   * be accessed through cheap views returned by values(), jacobians()
+   * and hessians().
+   *
+   * A tabulation is immutable after construction and can therefore be
+   * read concurrently from several threads.
+   *
+   * \tparam LB Type of the local basis
+   */
+  template<class LB>
+  class LocalBasisTabulation
+  {
+  public:
+    //! \brief Type of the tabulated local basis
+    typedef LB LocalBasis;
+
+    //! \brief Traits of the tabulated local basis
+    typedef typename LB::Traits Traits;
+
+    typedef typename Traits::DomainFieldType DomainFieldType;
+    typedef typename Traits::RangeFieldType RangeFieldType;
+    typedef typename Traits::RangeType RangeType;
+    typedef typename Traits::JacobianType JacobianType;
+    typedef typename Traits::HessianType HessianType;
+
+    //! \brief Quadrature rule providing the tabulation points
+    typedef QuadratureRule<DomainFieldType,Traits::dimDomain> QuadratureRuleType;
+
+    //! \brief Alignment in bytes of the sections in the data block
+    static const std::size_t alignment = 64;
+
+    /** \brief Lightweight read-only view of the entries of all shape functions at one point */
+    template<class T>
+    class View
+    {
+    public:
+      typedef T value_type;
+      typedef const T* const_iterator;
+
+      View(const T* data, std::size_t size) :
+        data_(data), size_(size)
+      {}
+
+      //! \brief Number of shape functions
+      std::size_t size() const
+      {
+        return size_;
+      }
+
+      //! \brief Entry of the i-th shape function
+      const T& operator[](std::size_t i) const
+      {
+        return data_[i];
+      }
+
+      const_iterator begin() const
+      {
+        return data_;
+      }
+
+      const_iterator end() const
+      {
+        return data_ + size_;
+      }
+
+      //! \brief Pointer to the contiguous data
+      const T* data() const
+      {
+        return data_;
+      }
+
+    private:
+      const T* data_;
+      std::size_t size_;
+    };
+
+    /** \brief Tabulate a local basis at the points of a quadrature rule
+     *
+     * \param basis The local basis to tabulate
+     * \param quad The quadrature rule providing the points
+     * \param withHessians Also tabulate second derivatives. This requires
+     *        the basis to implement evaluateHessian() or partial() for
+     *        derivatives of order two, see Dune::evaluateHessian.
+     */
+    LocalBasisTabulation(const LB& basis, const QuadratureRuleType& quad, bool withHessians = false) :
+      size_(basis.size()),
+      numPoints_(quad.size()),
+      hasHessians_(withHessians),
+      values_(nullptr),
+      jacobians_(nullptr),
+      hessians_(nullptr)
+    {
+      std::vector<typename Traits::DomainType> points(numPoints_);
+      for (std::size_t q=0; q<numPoints_; ++q)
+        points[q] = quad[q].position();
+
+      // evaluate everything first, such that nothing has been placed
+      // into the block if the basis throws
+      std::vector<RangeType> values;
+      evaluateFunctionBatch(basis, points, values);
+      std::vector<JacobianType> jacobians;
+      evaluateJacobianBatch(basis, points, jacobians);
+      std::vector<HessianType> hessians;
+      if (hasHessians_)
+        hessians = tabulateHessians(basis, points);
+
+      // Reserve one block for all sections. The offsets are rounded up
+      // such that each section starts at an aligned address.
+      const std::size_t entries = numPoints_*size_;
+      const std::size_t valueBytes = roundUp(entries*sizeof(RangeType));
+      const std::size_t jacobianBytes = roundUp(entries*sizeof(JacobianType));
+      const std::size_t hessianBytes = hasHessians_ ? roundUp(entries*sizeof(HessianType)) : 0;
+      storage_.reset(new char[valueBytes + jacobianBytes + hessianBytes + alignment]);
+      char* block = storage_.get();
+      block += (alignment - reinterpret_cast<std::uintptr_t>(block) % alignment) % alignment;
+
+      values_ = construct(block, values);
+      jacobians_ = construct(block + valueBytes, jacobians);
+      if (hasHessians_)
+        hessians_ = construct(block + valueBytes + jacobianBytes, hessians);
+    }
+
+    LocalBasisTabulation(const LocalBasisTabulation&) = delete;
+    LocalBasisTabulation& operator=(const LocalBasisTabulation&) = delete;
+
+    ~LocalBasisTabulation()
+    {
+      destroy(values_);
+      destroy(jacobians_);
+      destroy(hessians_);
+    }
+
+    //! \brief Number of shape functions
+    std::size_t size() const
+    {
+      return size_;
+    }
+
+    //! \brief Number of tabulation points
+    std::size_t numPoints() const
+    {
+      return numPoints_;
+    }
+
+    //! \brief Whether second derivatives have been tabulated
+    bool hasHessians() const
+    {
+      return hasHessians_;
+    }
+
+    //! \brief Values of all shape functions at the q-th point
+    View<RangeType> values(std::size_t q) const
+    {
+      return View<RangeType>(values_ + q*size_, size_);
+    }
+
+    //! \brief Jacobians of all shape functions at the q-th point
+    View<JacobianType> jacobians(std::size_t q) const
+    {
+      return View<JacobianType>(jacobians_ + q*size_, size_);
+    }
+
+    /** \brief Hessians of all shape functions at the q-th point
+     *
+     * Only available if the tabulation was created with withHessians=true.
+     */
+    View<HessianType> hessians(std::size_t q) const
+    {
+      if (not hasHessians_)
+        DUNE_THROW(Dune::InvalidStateException, "Hessians have not been tabulated");
+      return View<HessianType>(hessians_ + q*size_, size_);
+    }
+
+  private:
+    static std::size_t roundUp(std::size_t bytes)
+    {
+      return ((bytes + alignment - 1) / alignment) * alignment;
+    }
+
+    // copy-construct the entries of a vector into raw storage
+    template<class T>
+    T* construct(char* memory, const std::vector<T>& source) const
+    {
+      T* data = reinterpret_cast<T*>(memory);
+      for (std::size_t i=0; i<source.size(); ++i)
+        new (data + i) T(source[i]);
+      return data;
+    }
+
+    template<class T>
+    void destroy(T* data) const
+    {
+      if (data)
+        for (std::size_t i=0; i<numPoints_*size_; ++i)
+          data[i].~T();
+    }
+
+    std::vector<HessianType> tabulateHessians(const LB& basis, const std::vector<typename Traits::DomainType>& points) const
+    {
+      std::vector<HessianType> hessians(points.size()*size_);
+      std::vector<HessianType> pointHessians;
+      for (std::size_t q=0; q<points.size(); ++q)
+      {
+        Dune::evaluateHessian(basis, points[q], pointHessians);
+        std::copy(pointHessians.begin(), pointHessians.end(), hessians.begin()+q*size_);
+      }
+      return hessians;
+    }
+
+    std::size_t size_;
+    std::size_t numPoints_;
+    bool hasHessians_;
+    std::unique_ptr<char[]> storage_;
+    RangeType* values_;
+    JacobianType* jacobians_;
+    HessianType* hessians_;
+  };
+
+
+
+  /** \brief A thread-safe cache of tabulations of a local basis
+   *
+   * Tabulations are keyed by geometry type, quadrature order and
+   * quadrature type. Each tabulation is computed on first request and kept
+   * until the cache is destroyed. References handed out by get() stay valid
+   * for the lifetime of the cache, so a single cache can be shared by all
+   * threads of an assembler.
+   *
+   * The tabulations are kept in a list whose entries are published
+   * atomically and never change afterwards. Lookups of existing
+   * tabulations only read this list and never take a lock; the creation of
+   * missing tabulations is serialized by a mutex.
+   *
+   * The cache owns the basis it tabulates, either as a copy or by sharing
+   * ownership, so the basis passed to the constructor may be destroyed
+   * before the cache.
+   *
+   * \tparam LB Type of the local basis
+   */
+  template<class LB>
+  class LocalBasisTabulationCache
+  {
+  public:
+    //! \brief Type of the tabulations stored in this cache
+    typedef LocalBasisTabulation<LB> Tabulation;
+
+    /** \brief Create an empty cache for a copy of a basis
+     *
+     * \param basis The local basis to tabulate
+     * \param withHessians Also tabulate second derivatives
+     */
+    explicit LocalBasisTabulationCache(const LB& basis, bool withHessians = false) :
+      basis_(std::make_shared<const LB>(basis)),
+      withHessians_(withHessians)
+    {}
+
+    /** \brief Create an empty cache sharing the ownership of a basis
+     *
+     * \param basis The local basis to tabulate
+     * \param withHessians Also tabulate second derivatives
+     */
+    explicit LocalBasisTabulationCache(std::shared_ptr<const LB> basis, bool withHessians = false) :
+      basis_(std::move(basis)),
+      withHessians_(withHessians)
+    {}
+
+    LocalBasisTabulationCache(const LocalBasisTabulationCache&) = delete;
+    LocalBasisTabulationCache& operator=(const LocalBasisTabulationCache&) = delete;
+
+    ~LocalBasisTabulationCache()
+    {
+      const Entry* entry = head_.load(std::memory_order_relaxed);
+      while (entry)
+      {
+        const Entry* next = entry->next;
+        delete entry;
+        entry = next;
+      }
+    }
+
+    //! \brief Get the tabulation for a given quadrature rule
+    const Tabulation& get(const GeometryType& gt, int order,
+                          QuadratureType::Enum qt = QuadratureType::GaussLegendre) const
+    {
+      const Entry* entry = find(head_.load(std::memory_order_acquire), gt, order, qt);
+      if (entry)
+        return entry->tabulation;
+      return create(gt, order, qt);
+    }
+
+    //! \brief The tabulated local basis
+    const LB& basis() const
+    {
+      return *basis_;
+    }
+
+  private:
+    // an entry is immutable once it has been published
+    struct Entry
+    {
+      Entry(const GeometryType& gt_, int order_, QuadratureType::Enum qt_,
+            const LB& basis, bool withHessians, const Entry* next_) :
+        gt(gt_), order(order_), qt(qt_),
+        tabulation(basis, QuadratureRules<typename Tabulation::DomainFieldType,Tabulation::Traits::dimDomain>::rule(gt_, order_, qt_), withHessians),
+        next(next_)
+      {}
+
+      GeometryType gt;
+      int order;
+      QuadratureType::Enum qt;
+      Tabulation tabulation;
+      const Entry* next;
+    };
+
+    static const Entry* find(const Entry* entry, const GeometryType& gt, int order, QuadratureType::Enum qt)
+    {
+      for (; entry; entry = entry->next)
+        if (entry->gt == gt && entry->order == order && entry->qt == qt)
+          return entry;
+      return nullptr;
+    }
+
+    // slow path: tabulate while holding the lock, unless another thread
+    // has published the tabulation in the meantime
+    const Tabulation& create(const GeometryType& gt, int order, QuadratureType::Enum qt) const
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      const Entry* head = head_.load(std::memory_order_relaxed);
+      const Entry* entry = find(head, gt, order, qt);
+      if (!entry)
+      {
+        entry = new Entry(gt, order, qt, *basis_, withHessians_, head);
+        head_.store(entry, std::memory_order_release);
+      }
+      return entry->tabulation;
+    }
+
+    std::shared_ptr<const LB> basis_;
+    bool withHessians_;
+    mutable std::atomic<const Entry*> head_{nullptr};
+    mutable std::mutex mutex_;
+  };
+
+}
+
+#endif
@@ -43,27 +43,24 @@ namespace Dune
         \param c Codimension of the associated subentity
         \param i Index in the set of all functions associated to this subentity
      */
-    LocalKey (unsigned int s, unsigned int c, unsigned int i)
-    {
-      values_[0] = s;
-      values_[1] = c;
-      values_[2] = i;
-    }
+    constexpr LocalKey (unsigned int s, unsigned int c, unsigned int i)
+      : values_{{s, c, i}}
+    {}
 
     //! \brief Return number of associated subentity
-    inline unsigned int subEntity () const
+    constexpr unsigned int subEntity () const
     {
       return values_[0];
     }
 
     //! \brief Return codim of associated entity
-    inline unsigned int codim () const
+    constexpr unsigned int codim () const
     {
       return values_[1];
     }
 
     //! \brief Return offset within subentity
-    inline unsigned int index () const
+    constexpr unsigned int index () const
     {
       return values_[2];
     }
@@ -13,6 +13,8 @@
 
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/common/localbasis.hh>
+
 namespace Dune {
 
   //! Traits class for local-to-global basis adaptors
@@ -125,8 +127,7 @@ namespace Dune {
     void evaluateJacobian(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Jacobian>& out) const
     {
-      std::vector<typename LocalBasis::Traits::JacobianType>
-      localJacobian(size());
+      auto& localJacobian = Impl::threadScratch<ScalarLocalToGlobalBasisAdaptor, typename LocalBasis::Traits::JacobianType>();
       localBasis.evaluateJacobian(in, localJacobian);
 
       const typename Geometry::JacobianInverseTransposed &geoJacobian =
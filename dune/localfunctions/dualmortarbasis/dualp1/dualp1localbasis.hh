@@ -3,6 +3,7 @@
 #ifndef DUNE_DUAL_P1_LOCALBASIS_HH
 #define DUNE_DUAL_P1_LOCALBASIS_HH
 
+#include <array>
 #include <numeric>
 
 #include <dune/common/fvector.hh>
@@ -38,17 +39,18 @@ namespace Dune
         Dune::FieldMatrix<R,1,dim> > Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return dim+1;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
       // evaluate P1 basis functions
-      std::vector<typename Traits::RangeType> p1Values(size());
+      std::array<typename Traits::RangeType,dim+1> p1Values;
 
       p1Values[0] = 1.0;
 
@@ -58,7 +60,7 @@ namespace Dune
       }
 
       // compute dual basis function values as a linear combination of the Lagrange values
-      out.resize(size());
+      Impl::resizeOutput(out, size());
 
       for (int i=0; i<=dim; i++) {
         out[i] = (dim+!faceDual)*p1Values[i];
@@ -71,12 +73,13 @@ namespace Dune
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,
-                      std::vector<typename Traits::JacobianType>& out) const
+                      Out& out) const
     {
       // evaluate P1 jacobians
-      std::vector<typename Traits::JacobianType> p1Jacs(size());
+      std::array<typename Traits::JacobianType,dim+1> p1Jacs;
 
       for (int i=0; i<dim; i++)
         p1Jacs[0][0][i] = -1;
@@ -86,7 +89,7 @@ namespace Dune
           p1Jacs[i+1][0][j] = (i==j);
 
       // compute dual basis jacobians as linear combination of the Lagrange jacobians
-      out.resize(size());
+      Impl::resizeOutput(out, size());
 
       for (size_t i=0; i<=dim; i++) {
         out[i][0] = 0;
@@ -5,6 +5,7 @@
 
 #include <map>
 
+#include <dune/localfunctions/common/concurrentcache.hh>
 #include <dune/localfunctions/common/virtualinterface.hh>
 #include <dune/localfunctions/common/virtualwrappers.hh>
 
@@ -65,6 +66,17 @@ protected:
   mutable FEMap cache_;
 };
 
+/** \brief A variant of DualPQ1LocalFiniteElementCache that can be shared by several threads
+ *
+ * Lookups of elements that have been created before are lock-free,
+ * see ConcurrentLocalFiniteElementCache.
+ */
+template<class D, class R, int dim, bool faceDual=false>
+class ConcurrentDualPQ1LocalFiniteElementCache
+  : public ConcurrentLocalFiniteElementCache<typename DualPQ1LocalFiniteElementCache<D,R,dim,faceDual>::FiniteElementType,
+                                             DualPQ1LocalFiniteElementCache<D,R,dim,faceDual>, dim>
+{};
+
 }  // namespace Dune
 
 #endif   // DUNE_LOCALFUNCTIONS_DUAL_P1_Q1_FACTORY_HH
@@ -35,17 +35,18 @@ namespace Dune
     }
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1<<dim;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
       // compute q1 values
-      std::vector<typename Traits::RangeType> q1Values(size());
+      std::array<typename Traits::RangeType,(1<<dim)> q1Values;
 
       for (size_t i=0; i<size(); i++) {
 
@@ -58,7 +59,7 @@ namespace Dune
       }
 
       // compute the dual values by using that they are linear combinations of q1 functions
-      out.resize(size());
+      Impl::resizeOutput(out, size());
       for (size_t i=0; i<size(); i++)
         out[i] = 0;
 
@@ -70,12 +71,13 @@ namespace Dune
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,             // position
-                      std::vector<typename Traits::JacobianType>& out) const // return value
+                      Out& out) const // return value
     {
       // compute q1 jacobians
-      std::vector<typename Traits::JacobianType> q1Jacs(size());
+      std::array<typename Traits::JacobianType,(1<<dim)> q1Jacs;
 
       // Loop over all shape functions
       for (size_t i=0; i<size(); i++) {
@@ -100,7 +102,7 @@ namespace Dune
       }
 
       // compute the dual jacobians by using that they are linear combinations of q1 functions
-      out.resize(size());
+      Impl::resizeOutput(out, size());
       for (size_t i=0; i<size(); i++)
         out[i] = 0;
 
@@ -27,10 +27,11 @@ namespace Dune
    * if the point set can be build for a specified Topology.
    *
    * Examples include:
-   * - EqualdistantPointSet: standard point set for lagrange points
-   * - LobattoPointSet:      an approximate Freget type point set
-   *                         (provided for simplex and generalized prism
-   *                         topologies (i.e. not for a 3d pyramid)
+   * - EquidistantPointSet: standard point set for lagrange points
+   * - LobattoPointSet:     tensor products of Gauss-Lobatto points on cubes
+   *                        and an approximate Fekete type point set on
+   *                        simplices (provided for simplex, cube, and prism
+   *                        topologies, i.e., not for a 3d pyramid)
    *
    * \ingroup Lagrange
    *
@@ -0,0 +1,123 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_GAUSSLOBATTOPOINTS_HH
+#define DUNE_LOCALFUNCTIONS_LAGRANGE_GAUSSLOBATTOPOINTS_HH
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Dune
+{
+
+  // GaussLobattoPoints
+  // ------------------
+
+  /** \brief Gauss-Lobatto-Legendre points and weights on the interval [0,1]
+   *
+   * For order k >= 1 these are the k+1 roots of
+   * \f$(1-t^2)P_k'(t)\f$, mapped from [-1,1] to [0,1], where \f$P_k\f$ is
+   * the Legendre polynomial of degree k.  They include both end points and
+   * the quadrature rule with the associated weights is exact for
+   * polynomials of degree 2k-1.  For order 0 the midpoint rule is returned.
+   *
+   * The interior points are computed by Newton's method in double
+   * precision, followed by a few Newton steps in the field F, so that
+   * multi-precision fields obtain correspondingly accurate points.  The
+   * points are exactly symmetric, i.e., point k-i is 1 minus point i.
+   *
+   * \tparam F field type for points and weights
+   */
+  template< class F >
+  class GaussLobattoPoints
+  {
+  public:
+    typedef F Field;
+
+    explicit GaussLobattoPoints ( unsigned int order )
+      : points_( order+1 ), weights_( order+1 )
+    {
+      if( order == 0 )
+      {
+        points_[ 0 ] = F( 1 ) / F( 2 );
+        weights_[ 0 ] = F( 1 );
+        return;
+      }
+
+      const unsigned int k = order;
+      const double pi = std::acos( -1.0 );
+      for( unsigned int i = 0; 2*i <= k; ++i )
+      {
+        F t = F( -1 );
+        if( i > 0 )
+        {
+          // start from the Chebyshev-Gauss-Lobatto point
+          double s = -std::cos( pi * i / k );
+          for( int iteration = 0; iteration < 100; ++iteration )
+          {
+            const double ds = newtonStep( k, s );
+            s += ds;
+            if( std::abs( ds ) < 1e-15 )
+              break;
+          }
+          t = F( s );
+          for( int iteration = 0; iteration < 4; ++iteration )
+            t += newtonStep( k, t );
+        }
+
+        F pk, pkm1;
+        legendre( k, t, pk, pkm1 );
+        points_[ i ] = (F( 1 ) + t) / F( 2 );
+        weights_[ i ] = F( 1 ) / (F( k*(k+1) ) * pk * pk);
+
+        points_[ k-i ] = F( 1 ) - points_[ i ];
+        weights_[ k-i ] = weights_[ i ];
+      }
+      if( k % 2 == 0 )
+        points_[ k/2 ] = F( 1 ) / F( 2 );
+    }
+
+    //! \brief polynomial order, the number of points is order()+1
+    unsigned int order () const { return points_.size()-1; }
+
+    //! \brief number of points
+    std::size_t size () const { return points_.size(); }
+
+    //! \brief the points in ascending order
+    const std::vector< F > &points () const { return points_; }
+
+    //! \brief the quadrature weights, they sum up to one
+    const std::vector< F > &weights () const { return weights_; }
+
+  private:
+    // values of the Legendre polynomials of degree k and k-1 at t
+    template< class T >
+    static void legendre ( unsigned int k, const T &t, T &pk, T &pkm1 )
+    {
+      pkm1 = T( 1 );
+      pk = t;
+      for( unsigned int m = 1; m < k; ++m )
+      {
+        const T next = (T( 2*m+1 ) * t * pk - T( m ) * pkm1) / T( m+1 );
+        pkm1 = pk;
+        pk = next;
+      }
+    }
+
+    // Newton step for q(t) = (1-t^2) P_k'(t) = k (P_{k-1}(t) - t P_k(t)),
+    // using q'(t) = -k(k+1) P_k(t) from the Legendre differential equation
+    template< class T >
+    static T newtonStep ( unsigned int k, const T &t )
+    {
+      T pk, pkm1;
+      legendre( k, t, pk, pkm1 );
+      return (pkm1 - t * pk) / (T( k+1 ) * pk);
+    }
+
+    std::vector< F > points_;
+    std::vector< F > weights_;
+  };
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_GAUSSLOBATTOPOINTS_HH
@@ -3,9 +3,12 @@
 #ifndef DUNE_LAGRANGEBASIS_INTERPOLATION_HH
 #define DUNE_LAGRANGEBASIS_INTERPOLATION_HH
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/localfunctions/lagrange/lagrangecoefficients.hh>
+#include <dune/localfunctions/utility/constructionthreadpool.hh>
 
 namespace Dune
 {
@@ -62,14 +65,16 @@ namespace Dune
     template< class Matrix, class Basis >
     void interpolate ( const Basis &basis, Matrix &coefficients ) const
     {
-      typedef typename LagrangePointSet::iterator Iterator;
-
-      coefficients.resize( lagrangePoints_.size(), basis.size( ) );
-
-      unsigned int index = 0;
-      const Iterator end = lagrangePoints_.end();
-      for( Iterator it = lagrangePoints_.begin(); it != end; ++it )
-        basis.template evaluate<0>( it->point(), coefficients.rowPtr( index++ ) );
+      const unsigned int size = lagrangePoints_.size();
+      coefficients.resize( size, basis.size( ) );
+
+      // each row belongs to one point, blocks of points are evaluated in parallel
+      const unsigned int pointBlock = 16;
+      ConstructionThreadPool::instance().parallelFor( (size + pointBlock - 1) / pointBlock, [ & ] ( std::size_t b ) {
+          const unsigned int end = std::min( unsigned( b+1 )*pointBlock, size );
+          for( unsigned int index = b*pointBlock; index < end; ++index )
+            basis.template evaluate<0>( lagrangePoints_[ index ].point(), coefficients.rowPtr( index ) );
+        } );
     }
 
     const LagrangePointSet &lagrangePoints () const
@@ -0,0 +1,181 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
+#define DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
+
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/emptypoints.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/gausslobattopoints.hh>
+
+namespace Dune
+{
+
+  // LobattoPointSet
+  // ---------------
+
+  /** \brief Lagrange points based on the Gauss-Lobatto-Legendre points
+   *
+   * The points are numbered and attached to subentities exactly like those
+   * of the EquidistantPointSet of the same order, only their positions
+   * differ:
+   * - In the directions of a tensor product (the cube and the prism
+   *   directions) the coordinate i/k is replaced by the i-th
+   *   Gauss-Lobatto point of order k.  On cubes this gives the nodes of
+   *   the spectral elements; with the Gauss-Lobatto quadrature rule of the
+   *   same order the mass matrix is diagonal.
+   * - On simplices the points are an approximate Fekete type point set,
+   *   defined recursively over the dimension: the point with barycentric
+   *   multi-index \f$\alpha\f$, \f$|\alpha| = n\f$, is the weighted
+   *   average over the facets j of the point \f$\alpha\setminus j\f$ of
+   *   the facet, the weight being the Gauss-Lobatto point \f$n-\alpha_j\f$
+   *   of order n.  On edges these are the Gauss-Lobatto points, on facets
+   *   the points of the lower dimensional simplex, and replacing the
+   *   Gauss-Lobatto points by equidistant ones yields the equidistant
+   *   points.
+   *
+   * The point set is provided for products of a simplex with a cube, i.e.,
+   * for simplices, cubes, and prisms, but not for the 3d pyramid.
+   */
+  template< class F, unsigned int dim >
+  class LobattoPointSet
+    : public EmptyPointSet< F, dim >
+  {
+    typedef EmptyPointSet< F, dim > Base;
+
+  public:
+    static const unsigned int dimension = dim;
+
+    using Base::order;
+
+    LobattoPointSet ( unsigned int order ) : Base( order ) {}
+
+    bool build ( GeometryType gt )
+    {
+      assert( gt.dim() == dimension );
+      if( !supportsTopology( gt.id() ) )
+        return false;
+
+      // the equidistant points provide the numbering and the local keys
+      EquidistantPointSet< double, dimension > equidistant( order() );
+      equidistant.build( gt );
+
+      lobatto_.clear();
+      for( unsigned int n = 0; n <= order(); ++n )
+        lobatto_.push_back( GaussLobattoPoints< F >( n ).points() );
+
+      const unsigned int simplexDim = simplexDimension( gt.id() );
+      points_.resize( equidistant.size() );
+      std::vector< unsigned int > alpha( simplexDim+1 );
+      for( unsigned int i = 0; i < equidistant.size(); ++i )
+      {
+        const auto &x = equidistant[ i ].point();
+        points_[ i ].localKey_ = equidistant[ i ].localKey();
+        if( order() == 0 )
+        {
+          for( unsigned int j = 0; j < dimension; ++j )
+            points_[ i ].point_[ j ] = F( x[ j ] );
+          continue;
+        }
+
+        // integer coordinates on the equidistant lattice
+        unsigned int sum = 0;
+        for( unsigned int j = 0; j < simplexDim; ++j )
+        {
+          alpha[ j ] = std::lround( x[ j ] * order() );
+          sum += alpha[ j ];
+        }
+        alpha[ simplexDim ] = order() - sum;
+
+        if( simplexDim > 0 )
+        {
+          const std::vector< F > lambda = simplexPoint( alpha );
+          for( unsigned int j = 0; j < simplexDim; ++j )
+            points_[ i ].point_[ j ] = lambda[ j ];
+        }
+        for( unsigned int j = simplexDim; j < dimension; ++j )
+          points_[ i ].point_[ j ] = lobatto_[ order() ][ std::lround( x[ j ] * order() ) ];
+      }
+      return true;
+    }
+
+    template< class T >
+    bool build ()
+    {
+      return build( GeometryType( T() ) );
+    }
+
+    template< class T >
+    static bool supports ( unsigned int order )
+    {
+      return supportsTopology( GeometryType( T() ).id() );
+    }
+
+  private:
+    // The topology is the product of a simplex in the first coordinates
+    // and a cube in the remaining ones iff no pyramid direction follows a
+    // prism direction (direction 0 is a line and counts as both).
+    static bool supportsTopology ( unsigned int topologyId )
+    {
+      return (topologyId >> simplexDimension( topologyId )) + 1 == (1u << (dimension - simplexDimension( topologyId )));
+    }
+
+    // number of leading coordinates spanning a simplex
+    static unsigned int simplexDimension ( unsigned int topologyId )
+    {
+      unsigned int s = (dimension > 0 ? 1 : 0);
+      while( (s < dimension) && !Impl::isPrism( topologyId, dimension, dimension-s-1 ) )
+        ++s;
+      return s;
+    }
+
+    // barycentric coordinates of the point with barycentric multi-index alpha
+    std::vector< F > simplexPoint ( const std::vector< unsigned int > &alpha ) const
+    {
+      const unsigned int n = std::accumulate( alpha.begin(), alpha.end(), 0u );
+      std::vector< F > lambda( alpha.size(), F( 0 ) );
+      if( alpha.size() == 2 )
+      {
+        lambda[ 0 ] = lobatto_[ n ][ alpha[ 0 ] ];
+        lambda[ 1 ] = lobatto_[ n ][ alpha[ 1 ] ];
+        return lambda;
+      }
+
+      F weightSum( 0 );
+      std::vector< unsigned int > facetAlpha( alpha.size()-1 );
+      for( unsigned int j = 0; j < alpha.size(); ++j )
+      {
+        // the facet opposite to a vertex carrying all of alpha has weight zero
+        if( alpha[ j ] == n )
+          continue;
+
+        for( unsigned int l = 0, m = 0; l < alpha.size(); ++l )
+          if( l != j )
+            facetAlpha[ m++ ] = alpha[ l ];
+        const std::vector< F > facetLambda = simplexPoint( facetAlpha );
+
+        const F &weight = lobatto_[ n ][ n - alpha[ j ] ];
+        for( unsigned int l = 0, m = 0; l < alpha.size(); ++l )
+          if( l != j )
+            lambda[ l ] += weight * facetLambda[ m++ ];
+        weightSum += weight;
+      }
+      for( unsigned int l = 0; l < alpha.size(); ++l )
+        lambda[ l ] /= weightSum;
+      return lambda;
+    }
+
+    using Base::points_;
+    // lobatto_[n] holds the Gauss-Lobatto points of order n
+    std::vector< std::vector< F > > lobatto_;
+  };
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_LOBATTOPOINTS_HH
@@ -32,25 +32,27 @@ namespace Dune
         Dune::FieldMatrix<R,1,d>, 0> Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
-      out.resize(1);
+      Impl::resizeOutput(out, 1);
       out[0] = 1;
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,         // position
-                      std::vector<typename Traits::JacobianType>& out) const      // return value
+                      Out& out) const      // return value
     {
-      out.resize(1);
+      Impl::resizeOutput(out, 1);
       for (int i=0; i<d; i++)
         out[0][0][i] = 0;
     }
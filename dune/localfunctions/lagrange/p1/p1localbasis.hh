@@ -4,6 +4,7 @@
 #define DUNE_P1_LOCALBASIS_HH
 
 #include <array>
+#include <cstddef>
 #include <numeric>
 
 #include <dune/common/fmatrix.hh>
@@ -32,37 +33,54 @@ namespace Dune
         Dune::FieldMatrix<R,1,dim>, 2> Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return dim+1;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
-      out.resize(size());
-      out[0] = 1.0;
-      for (size_t i=0; i<dim; i++) {
-        out[0]  -= in[i];
-        out[i+1] = in[i];
-      }
+      Impl::resizeOutput(out, size());
+      evaluateFunctionAt(in, out.begin());
+    }
+
+    /** \brief Evaluate all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Values, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateFunctionBatch (const Points& points,
+                                std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateFunctionAt(points[q], out.begin()+q*size());
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,         // position
-                      std::vector<typename Traits::JacobianType>& out) const      // return value
+                      Out& out) const      // return value
     {
-      out.resize(size());
-
-      for (int i=0; i<dim; i++)
-        out[0][0][i] = -1;
-
-      for (int i=0; i<dim; i++)
-        for (int j=0; j<dim; j++)
-          out[i+1][0][j] = (i==j);
+      Impl::resizeOutput(out, size());
+      evaluateJacobianAt(out.begin());
+    }
 
+    /** \brief Evaluate Jacobian of all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Jacobians, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateJacobianBatch (const Points& points,
+                                std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateJacobianAt(out.begin()+q*size());
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -96,11 +114,45 @@ namespace Dune
       }
     }
 
+    //! \brief Evaluate the second derivatives of all shape functions, which vanish
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& in,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, size());
+      for (int i=0; i<dim+1; i++)
+        out[i][0] = 0;
+    }
+
     //! \brief Polynomial order of the shape functions
     unsigned int order () const
     {
       return 1;
     }
+
+  private:
+    // Evaluate all shape functions at one point, writing to out[0],...,out[dim]
+    template<class Iterator>
+    void evaluateFunctionAt (const typename Traits::DomainType& in, Iterator out) const
+    {
+      out[0] = 1.0;
+      for (size_t i=0; i<dim; i++) {
+        out[0]  -= in[i];
+        out[i+1] = in[i];
+      }
+    }
+
+    // The Jacobians are constant, hence no position is needed
+    template<class Iterator>
+    void evaluateJacobianAt (Iterator out) const
+    {
+      for (int i=0; i<dim; i++)
+        out[0][0][i] = -1;
+
+      for (int i=0; i<dim; i++)
+        for (int j=0; j<dim; j++)
+          out[i+1][0][j] = (i==j);
+    }
   };
 }
 #endif
@@ -4,8 +4,8 @@
 #define DUNE_P1_LOCALCOEFFICIENTS_HH
 
 #include <cstddef>
+#include <array>
 #include <iostream>
-#include <vector>
 
 #include <dune/localfunctions/common/localkey.hh>
 
@@ -22,14 +22,14 @@ namespace Dune
   {
   public:
     //! \brief Standard constructor
-    P1LocalCoefficients () : li(size())
+    P1LocalCoefficients ()
     {
       for (std::size_t i=0; i<size(); i++)
         li[i] = LocalKey(i,dim,0);
     }
 
     //! number of coefficients
-    std::size_t size () const
+    static constexpr std::size_t size ()
     {
       return dim+1;
     }
@@ -41,7 +41,7 @@ namespace Dune
     }
 
   private:
-    std::vector<LocalKey> li;
+    std::array<LocalKey,dim+1> li;
   };
 
 }
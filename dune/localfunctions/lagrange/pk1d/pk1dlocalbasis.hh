@@ -6,6 +6,7 @@
 #include <dune/common/fmatrix.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/pkfactortables.hh>
 
 namespace Dune
 {
@@ -38,7 +39,8 @@ namespace Dune
         R,
         1,
         Dune::FieldVector<R,1>,
-        Dune::FieldMatrix<R,1,1>
+        Dune::FieldMatrix<R,1,1>,
+        2
         > Traits;
 
     //! \brief Standard constructor
@@ -115,14 +117,33 @@ namespace Dune
                  const typename Traits::DomainType& in,
                  std::vector<typename Traits::RangeType>& out) const
     {
-      switch (order[0])
-      {
-        case 0:
-          evaluateFunction(in,out);
-          break;
-        default:
-          DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+      if (order[0] == 0) {
+        evaluateFunction(in, out);
+        return;
       }
+
+      out.resize(N);
+      const Tables tables(in, order[0]);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        out[n++] = tables.partial(alpha, order);
+      });
+    }
+
+    /** \brief Evaluate the second derivatives of all shape functions
+     * \param x Position where to evaluate the derivatives
+     * \param[out] out Hessians, see LocalBasisTraits::HessianType
+     */
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& x,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, N);
+      const Tables tables(x, 2);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        tables.hessian(alpha, out[n++][0]);
+      });
     }
     //! \brief Polynomial order of the shape functions
     unsigned int order () const
@@ -131,6 +152,10 @@ namespace Dune
     }
 
   private:
+    // the shape function of node i is l_i(x) l_{k-i}(1-x) in the notation
+    // of the factor tables of the simplex
+    typedef Impl::PkFactorTables<D,R,k,1> Tables;
+
     R pos[k+1];     // positions on the interval
   };
 
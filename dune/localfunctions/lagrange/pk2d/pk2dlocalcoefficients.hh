@@ -4,8 +4,8 @@
 #ifndef DUNE_PK2DLOCALCOEFFICIENTS_HH
 #define DUNE_PK2DLOCALCOEFFICIENTS_HH
 
+#include <array>
 #include <cstddef>
-#include <vector>
 
 #include <dune/localfunctions/common/localkey.hh>
 
@@ -25,13 +25,13 @@ namespace Dune
 
   public:
     //! \brief Standard constructor
-    Pk2DLocalCoefficients () : li(N)
+    Pk2DLocalCoefficients ()
     {
       fill_default();
     }
 
     //! constructor for eight variants with order on edges flipped
-    Pk2DLocalCoefficients (int variant) : li(N)
+    Pk2DLocalCoefficients (int variant)
     {
       fill_default();
       bool flip[3];
@@ -52,7 +52,7 @@ namespace Dune
         random-access iterator.
      */
     template<class VertexMap>
-    explicit Pk2DLocalCoefficients(const VertexMap &vertexmap) : li(N)
+    explicit Pk2DLocalCoefficients(const VertexMap &vertexmap)
     {
       fill_default();
       bool flip[3];
@@ -65,7 +65,7 @@ namespace Dune
     }
 
     //! number of coefficients
-    std::size_t size () const
+    static constexpr std::size_t size ()
     {
       return N;
     }
@@ -77,7 +77,7 @@ namespace Dune
     }
 
   private:
-    std::vector<LocalKey> li;
+    std::array<LocalKey,N> li;
 
     void fill_default ()
     {
@@ -3,11 +3,13 @@
 #ifndef DUNE_PK3DLOCALBASIS_HH
 #define DUNE_PK3DLOCALBASIS_HH
 
+#include <cstddef>
 #include <numeric>
 
 #include <dune/common/fmatrix.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/pkfactortables.hh>
 
 namespace Dune
 {
@@ -17,6 +19,11 @@ namespace Dune
      Lagrange shape functions of arbitrary order have the property that
      \f$\hat\phi^i(x_j) = \delta_{i,j}\f$ for certain points \f$x_j\f$.
 
+     Each shape function is a product of one-dimensional Lagrange
+     polynomials in the barycentric coordinates.  All evaluation methods
+     tabulate these factors once per point, see Impl::PkFactorTables, so
+     that values and derivatives cost O(k^3) per point.
+
      \tparam D Type to represent the field in the domain.
      \tparam R Type to represent the field in the range.
      \tparam k Polynomial order.
@@ -31,122 +38,60 @@ namespace Dune
     enum {O = k};
 
     typedef LocalBasisTraits<D,3,Dune::FieldVector<D,3>,R,1,Dune::FieldVector<R,1>,
-        Dune::FieldMatrix<R,1,3> > Traits;
+        Dune::FieldMatrix<R,1,3>, 2 > Traits;
 
     //! \brief Standard constructor
     Pk3DLocalBasis () {}
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return N;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& x,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& x,
+                           Out& out) const
     {
-      out.resize(N);
-      typename Traits::DomainType kx = x;
-      kx *= k;
-      unsigned int n = 0;
-      unsigned int i[4];
-      R factor[4];
-      for (i[2] = 0; i[2] <= k; ++i[2])
-      {
-        factor[2] = 1.0;
-        for (unsigned int j = 0; j < i[2]; ++j)
-          factor[2] *= (kx[2]-j) / (i[2]-j);
-        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
-        {
-          factor[1] = 1.0;
-          for (unsigned int j = 0; j < i[1]; ++j)
-            factor[1] *= (kx[1]-j) / (i[1]-j);
-          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0])
-          {
-            factor[0] = 1.0;
-            for (unsigned int j = 0; j < i[0]; ++j)
-              factor[0] *= (kx[0]-j) / (i[0]-j);
-            i[3] = k - i[0] - i[1] - i[2];
-            D kx3 = k - kx[0] - kx[1] - kx[2];
-            factor[3] = 1.0;
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] *= (kx3-j) / (i[3]-j);
-            out[n++] = factor[0] * factor[1] * factor[2] * factor[3];
-          }
-        }
-      }
+      Impl::resizeOutput(out, N);
+      evaluateFunctionAt(x, out.begin());
+    }
+
+    /** \brief Evaluate all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Values, out[q*N+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateFunctionBatch (const Points& points,
+                                std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateFunctionAt(points[q], out.begin()+q*N);
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& x,         // position
-                      std::vector<typename Traits::JacobianType>& out) const      // return value
+                      Out& out) const      // return value
     {
-      out.resize(N);
-      typename Traits::DomainType kx = x;
-      kx *= k;
-      unsigned int n = 0;
-      unsigned int i[4];
-      R factor[4];
-      for (i[2] = 0; i[2] <= k; ++i[2])
-      {
-        factor[2] = 1.0;
-        for (unsigned int j = 0; j < i[2]; ++j)
-          factor[2] *= (kx[2]-j) / (i[2]-j);
-        for (i[1] = 0; i[1] <= k - i[2]; ++i[1])
-        {
-          factor[1] = 1.0;
-          for (unsigned int j = 0; j < i[1]; ++j)
-            factor[1] *= (kx[1]-j) / (i[1]-j);
-          for (i[0] = 0; i[0] <= k - i[1] - i[2]; ++i[0])
-          {
-            factor[0] = 1.0;
-            for (unsigned int j = 0; j < i[0]; ++j)
-              factor[0] *= (kx[0]-j) / (i[0]-j);
-            i[3] = k - i[0] - i[1] - i[2];
-            D kx3 = k - kx[0] - kx[1] - kx[2];
-            R sum3 = 0.0;
-            factor[3] = 1.0;
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] /= i[3] - j;
-            R prod_all = factor[0] * factor[1] * factor[2] * factor[3];
-            for (unsigned int j = 0; j < i[3]; ++j)
-            {
-              R prod = prod_all;
-              for (unsigned int l = 0; l < i[3]; ++l)
-                if (j == l)
-                  prod *= -R(k);
-                else
-                  prod *= kx3 - l;
-              sum3 += prod;
-            }
-            for (unsigned int j = 0; j < i[3]; ++j)
-              factor[3] *= kx3 - j;
-            for (unsigned int m = 0; m < 3; ++m)
-            {
-              out[n][0][m] = sum3;
-              for (unsigned int j = 0; j < i[m]; ++j)
-              {
-                R prod = factor[3];
-                for (unsigned int p = 0; p < 3; ++p)
-                {
-                  if (m == p)
-                    for (unsigned int l = 0; l < i[p]; ++l)
-                      if (j == l)
-                        prod *= R(k) / (i[p]-l);
-                      else
-                        prod *= (kx[p]-l) / (i[p]-l);
-                  else
-                    prod *= factor[p];
-                }
-                out[n][0][m] += prod;
-              }
-            }
-            n++;
-          }
-        }
-      }
+      Impl::resizeOutput(out, N);
+      evaluateJacobianAt(x, out.begin());
+    }
+
+    /** \brief Evaluate Jacobian of all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Jacobians, out[q*N+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateJacobianBatch (const Points& points,
+                                std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*N);
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateJacobianAt(points[q], out.begin()+q*N);
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -161,9 +106,31 @@ namespace Dune
       auto totalOrder = std::accumulate(order.begin(), order.end(), 0);
       if (totalOrder == 0) {
         evaluateFunction(in, out);
-      } else {
-        DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+        return;
       }
+
+      out.resize(N);
+      const Tables tables(in, totalOrder);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        out[n++] = tables.partial(alpha, order);
+      });
+    }
+
+    /** \brief Evaluate the second derivatives of all shape functions
+     * \param x Position where to evaluate the derivatives
+     * \param[out] out Hessians, see LocalBasisTraits::HessianType
+     */
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& x,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, N);
+      const Tables tables(x, 2);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        tables.hessian(alpha, out[n++][0]);
+      });
     }
 
     //! \brief Polynomial order of the shape functions
@@ -171,6 +138,31 @@ namespace Dune
     {
       return k;
     }
+
+  private:
+    typedef Impl::PkFactorTables<D,R,k,3> Tables;
+
+    // Evaluate all shape functions at one point, writing to out[0],...,out[N-1]
+    template<class Iterator>
+    void evaluateFunctionAt (const typename Traits::DomainType& x, Iterator out) const
+    {
+      const Tables tables(x, 0);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        out[n++] = tables.value(alpha);
+      });
+    }
+
+    // Evaluate all Jacobians at one point, writing to out[0],...,out[N-1]
+    template<class Iterator>
+    void evaluateJacobianAt (const typename Traits::DomainType& x, Iterator out) const
+    {
+      const Tables tables(x, 1);
+      unsigned int n = 0;
+      Tables::forEachIndex([&](const typename Tables::Index& alpha) {
+        tables.gradient(alpha, out[n++]);
+      });
+    }
   };
 
 
@@ -180,7 +172,7 @@ namespace Dune
   {
   public:
     typedef LocalBasisTraits<D,3,Dune::FieldVector<D,3>,R,1,Dune::FieldVector<R,1>,
-        Dune::FieldMatrix<R,1,3> > Traits;
+        Dune::FieldMatrix<R,1,3>, 2 > Traits;
 
     /** \brief Export the number of degrees of freedom */
     enum {N = 1};
@@ -188,24 +180,26 @@ namespace Dune
     /** \brief Export the element order */
     enum {O = 0};
 
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1;
     }
 
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
-      out.resize(1);
+      Impl::resizeOutput(out, 1);
       out[0] = 1;
     }
 
     // evaluate derivative of a single component
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,         // position
-                      std::vector<typename Traits::JacobianType>& out) const      // return value
+                      Out& out) const      // return value
     {
-      out.resize(1);
+      Impl::resizeOutput(out, 1);
       out[0][0][0] = 0;
       out[0][0][1] = 0;
       out[0][0][2] = 0;
@@ -229,6 +223,15 @@ namespace Dune
       }
     }
 
+    //! \brief Evaluate the second derivatives of all shape functions, which vanish
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& in,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, 1);
+      out[0][0] = 0;
+    }
+
     // local interpolation of a function
     template<typename E, typename F, typename C>
     void interpolate (const E& e, const F& f, std::vector<C>& out) const
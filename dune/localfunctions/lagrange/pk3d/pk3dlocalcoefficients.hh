@@ -4,8 +4,8 @@
 #define DUNE_PK3DLOCALCOEFFICIENTS_HH
 
 #include <cstddef>
+#include <array>
 #include <iostream>
-#include <vector>
 
 #include <dune/localfunctions/common/localkey.hh>
 
@@ -25,7 +25,7 @@ namespace Dune
 
   public:
     //! \brief Standard constructor
-    Pk3DLocalCoefficients () : li(N)
+    Pk3DLocalCoefficients ()
     {
       const unsigned int vertexmap[4] = {0, 1, 2, 3};
       generate_local_keys(vertexmap);
@@ -37,13 +37,13 @@ namespace Dune
         can for instance be generated from the global indices of
         the vertices by reducing those to the integers 0...3
      */
-    Pk3DLocalCoefficients (const unsigned int vertexmap[4]) : li(N)
+    Pk3DLocalCoefficients (const unsigned int vertexmap[4])
     {
       generate_local_keys(vertexmap);
     }
 
     //! number of coefficients
-    std::size_t size () const
+    static constexpr std::size_t size ()
     {
       return N;
     }
@@ -55,7 +55,7 @@ namespace Dune
     }
 
   private:
-    std::vector<LocalKey> li;
+    std::array<LocalKey,N> li;
 
     void generate_local_keys(const unsigned int vertexmap[4])
     {
@@ -0,0 +1,261 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_LAGRANGE_PKFACTORTABLES_HH
+#define DUNE_LOCALFUNCTIONS_LAGRANGE_PKFACTORTABLES_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#include <dune/common/fvector.hh>
+
+namespace Dune
+{
+  namespace Impl
+  {
+
+    /** \brief Tables of the one-dimensional factors of the Lagrange shape
+     *         functions of order k on the reference simplex at one point
+     *
+     * The shape function belonging to the Lagrange node x_alpha = alpha/k,
+     * given by its barycentric multi-index alpha with |alpha| = k, is
+     * \f[
+     *   \phi_\alpha(x) = \prod_{m=0}^{dim} \ell_{\alpha_m}(\lambda_m(x)),
+     *   \qquad \ell_i(t) = \prod_{j=0}^{i-1} \frac{kt-j}{i-j},
+     * \f]
+     * with the barycentric coordinates \f$\lambda_m = x_m\f$ for m < dim
+     * and \f$\lambda_{dim} = 1 - \sum_m x_m\f$.
+     *
+     * The constructor tabulates the derivatives up to a given order of all
+     * factors \f$\ell_i(\lambda_m)\f$ by the recursion
+     * \f$\ell_i = \ell_{i-1} (kt-i+1)/i\f$ and its Leibniz rule, which costs
+     * O(dim k r) operations for derivatives up to order r.  Afterwards every
+     * value or derivative of a shape function is a short sum of products of
+     * dim+1 table entries, instead of a product of k factors per term.
+     *
+     * \tparam D Type to represent the field in the domain.
+     * \tparam R Type to represent the field in the range.
+     * \tparam k Polynomial order.
+     * \tparam dim Dimension of the simplex.
+     */
+    template<class D, class R, unsigned int k, int dim>
+    class PkFactorTables
+    {
+    public:
+      //! Barycentric multi-index of a shape function
+      typedef std::array<unsigned int,dim+1> Index;
+
+      /** \brief Tabulate the factors at the point x
+       * \param x Position in the reference simplex
+       * \param maxOrder Highest derivative order that is needed
+       */
+      PkFactorTables (const FieldVector<D,dim>& x, unsigned int maxOrder)
+        : maxOrder_(std::min(maxOrder, k))
+      {
+        for (int m=0; m<=dim; m++)
+        {
+          // convert explicitly, so that vectorized field types need
+          // no mixed arithmetic with int
+          R t = R(1);
+          if (m < dim)
+            t = R(x[m]);
+          else
+            for (int c=0; c<dim; c++)
+              t -= R(x[c]);
+
+          auto& table = tables_[m];
+          table[0][0] = R(1);
+          for (unsigned int s=1; s<=maxOrder_; s++)
+            table[s][0] = R(0);
+          for (unsigned int i=1; i<=k; i++)
+          {
+            const R factor = (R(k)*t - R(i-1))/R(i);
+            const R slope = R(k)/R(i);
+            for (unsigned int s=maxOrder_; s>0; s--)
+              table[s][i] = table[s][i-1]*factor + R(s)*slope*table[s-1][i-1];
+            table[0][i] = table[0][i-1]*factor;
+          }
+        }
+      }
+
+      /** \brief Call f(alpha) for the barycentric multi-indices of all shape functions
+       *
+       * The order is the one of the shape functions of the Pk bases: the
+       * first coordinate runs fastest, the last Cartesian one slowest.
+       */
+      template<class F>
+      static void forEachIndex (F&& f)
+      {
+        Index alpha;
+        alpha.fill(0);
+        while (true)
+        {
+          unsigned int sum = 0;
+          for (int c=0; c<dim; c++)
+            sum += alpha[c];
+          alpha[dim] = k - sum;
+          f(static_cast<const Index&>(alpha));
+
+          // advance like an odometer, restricted to |alpha| <= k
+          int c = 0;
+          for (; c<dim; c++)
+          {
+            if (sum < k)
+            {
+              alpha[c]++;
+              break;
+            }
+            sum -= alpha[c];
+            alpha[c] = 0;
+          }
+          if (c == dim)
+            return;
+        }
+      }
+
+      //! \brief Value of the shape function alpha
+      R value (const Index& alpha) const
+      {
+        R result = tables_[0][0][alpha[0]];
+        for (int m=1; m<=dim; m++)
+          result *= tables_[m][0][alpha[m]];
+        return result;
+      }
+
+      /** \brief Gradient of the shape function alpha
+       *
+       * Requires maxOrder >= 1 in the constructor.
+       */
+      template<class Jacobian>
+      void gradient (const Index& alpha, Jacobian& jacobian) const
+      {
+        assert(maxOrder_ >= 1 or k == 0);
+        const R last = product(alpha, dim);
+        for (int c=0; c<dim; c++)
+          jacobian[0][c] = product(alpha, c) - last;
+      }
+
+      /** \brief Hessian of the shape function alpha
+       *
+       * With the derivative \f$P_{mn}\f$ of the product with respect to the
+       * barycentric coordinates m and n this is
+       * \f$H_{ab} = P_{ab} - P_{a,dim} - P_{dim,b} + P_{dim,dim}\f$.
+       * Requires maxOrder >= 2 in the constructor.
+       */
+      template<class Hessian>
+      void hessian (const Index& alpha, Hessian& hessian) const
+      {
+        assert(maxOrder_ >= 2 or k < 2);
+        std::array<R,dim> mixed;
+        const R last = secondProduct(alpha, dim, dim);
+        for (int a=0; a<dim; a++)
+          mixed[a] = secondProduct(alpha, a, dim);
+        for (int a=0; a<dim; a++)
+          for (int b=a; b<dim; b++)
+          {
+            hessian[a][b] = secondProduct(alpha, a, b) - mixed[a] - mixed[b] + last;
+            hessian[b][a] = hessian[a][b];
+          }
+      }
+
+      /** \brief Partial derivative of any order of the shape function alpha
+       *
+       * By \f$\partial_c = \partial_{\lambda_c} - \partial_{\lambda_{dim}}\f$
+       * the derivative is the sum over \f$\gamma \le \beta\f$ of
+       * \f$\prod_c \binom{\beta_c}{\gamma_c} (-1)^{\gamma_c}
+       *   \ell^{(\beta_c-\gamma_c)}_{\alpha_c}
+       *   \cdot \ell^{(|\gamma|)}_{\alpha_{dim}}\f$.
+       * Requires maxOrder >= |beta| in the constructor.
+       *
+       * \param alpha Barycentric multi-index of the shape function
+       * \param beta Order of the derivative, in the classic multi-index notation
+       */
+      R partial (const Index& alpha, const std::array<unsigned int,dim>& beta) const
+      {
+        std::array<unsigned int,dim> gamma;
+        gamma.fill(0);
+        R result = R(0);
+        while (true)
+        {
+          unsigned int lastOrder = 0;
+          double coefficient = 1;
+          for (int c=0; c<dim; c++)
+          {
+            lastOrder += gamma[c];
+            coefficient *= binomial(beta[c], gamma[c]);
+            if (gamma[c] % 2)
+              coefficient = -coefficient;
+          }
+
+          R term = R(coefficient)*factor(dim, lastOrder, alpha[dim]);
+          for (int c=0; c<dim; c++)
+            term *= factor(c, beta[c]-gamma[c], alpha[c]);
+          result += term;
+
+          // next gamma <= beta
+          int c = 0;
+          for (; c<dim; c++)
+          {
+            if (gamma[c] < beta[c])
+            {
+              gamma[c]++;
+              break;
+            }
+            gamma[c] = 0;
+          }
+          if (c == dim)
+            return result;
+        }
+      }
+
+    private:
+      // s-th derivative of the factor l_i(lambda_m), derivatives of an
+      // order beyond i vanish
+      R factor (int m, unsigned int s, unsigned int i) const
+      {
+        if (s > i)
+          return R(0);
+        assert(s <= maxOrder_);
+        return tables_[m][s][i];
+      }
+
+      // derivative of the product of all factors with respect to the
+      // barycentric coordinate n
+      R product (const Index& alpha, int n) const
+      {
+        R result = factor(n, 1, alpha[n]);
+        for (int m=0; m<=dim; m++)
+          if (m != n)
+            result *= tables_[m][0][alpha[m]];
+        return result;
+      }
+
+      // second derivative of the product of all factors with respect to
+      // the barycentric coordinates m and n
+      R secondProduct (const Index& alpha, int m, int n) const
+      {
+        R result = (m == n) ? factor(m, 2, alpha[m])
+                   : factor(m, 1, alpha[m])*factor(n, 1, alpha[n]);
+        for (int l=0; l<=dim; l++)
+          if (l != m and l != n)
+            result *= tables_[l][0][alpha[l]];
+        return result;
+      }
+
+      static double binomial (unsigned int n, unsigned int j)
+      {
+        double result = 1;
+        for (unsigned int i=1; i<=j; i++)
+          result = result*(n-j+i)/i;
+        return result;
+      }
+
+      unsigned int maxOrder_;
+      // tables_[m][s][i] is the s-th derivative of l_i at lambda_m
+      std::array<std::array<std::array<R,k+1>,k+1>,dim+1> tables_;
+    };
+
+  } // namespace Impl
+} // namespace Dune
+
+#endif // DUNE_LOCALFUNCTIONS_LAGRANGE_PKFACTORTABLES_HH
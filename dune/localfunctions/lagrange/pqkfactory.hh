@@ -7,6 +7,7 @@
 
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/common/concurrentcache.hh>
 #include <dune/localfunctions/common/virtualinterface.hh>
 #include <dune/localfunctions/common/virtualwrappers.hh>
 
@@ -161,6 +162,24 @@ namespace Dune
 
   };
 
+
+
+  /** \brief A variant of PQkLocalFiniteElementCache that can be shared by several threads
+   *
+   * Lookups of elements that have been created before are lock-free,
+   * see ConcurrentLocalFiniteElementCache.
+   *
+   * \tparam D Type used for domain coordinates
+   * \tparam R Type used for shape function values
+   * \tparam dim Element dimension
+   * \tparam k Element order
+   */
+  template<class D, class R, int dim, int k>
+  class ConcurrentPQkLocalFiniteElementCache
+    : public ConcurrentLocalFiniteElementCache<typename PQkLocalFiniteElementFactory<D,R,dim,k>::FiniteElementType,
+                                               PQkLocalFiniteElementFactory<D,R,dim,k>, dim>
+  {};
+
 }
 
 #endif
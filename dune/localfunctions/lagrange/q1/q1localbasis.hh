@@ -3,6 +3,7 @@
 #ifndef DUNE_Q1_LOCALBASIS_HH
 #define DUNE_Q1_LOCALBASIS_HH
 
+#include <cstddef>
 #include <numeric>
 
 #include <dune/common/fmatrix.hh>
@@ -30,58 +31,54 @@ namespace Dune
         Dune::FieldMatrix<R,1,dim> > Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return 1<<dim;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
-      out.resize(size());
-
-      for (size_t i=0; i<size(); i++) {
-
-        out[i] = 1;
-
-        for (int j=0; j<dim; j++)
-          // if j-th bit of i is set multiply with in[j], else with 1-in[j]
-          out[i] *= (i & (1<<j)) ? in[j] :  1-in[j];
-
-      }
+      Impl::resizeOutput(out, size());
+      evaluateFunctionAt(in, out.begin());
+    }
 
+    /** \brief Evaluate all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Values, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateFunctionBatch (const Points& points,
+                                std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateFunctionAt(points[q], out.begin()+q*size());
     }
 
     //! \brief Evaluate Jacobian of all shape functions
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,         // position
-                      std::vector<typename Traits::JacobianType>& out) const      // return value
+                      Out& out) const      // return value
     {
-      out.resize(size());
-
-      // Loop over all shape functions
-      for (size_t i=0; i<size(); i++) {
-
-        // Loop over all coordinate directions
-        for (int j=0; j<dim; j++) {
-
-          // Initialize: the overall expression is a product
-          // if j-th bit of i is set to -1, else 1
-          out[i][0][j] = (i & (1<<j)) ? 1 : -1;
-
-          for (int k=0; k<dim; k++) {
-
-            if (j!=k)
-              // if k-th bit of i is set multiply with in[j], else with 1-in[j]
-              out[i][0][j] *= (i & (1<<k)) ? in[k] :  1-in[k];
-
-          }
-
-        }
-
-      }
+      Impl::resizeOutput(out, size());
+      evaluateJacobianAt(in, out.begin());
+    }
 
+    /** \brief Evaluate Jacobian of all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Jacobians, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateJacobianBatch (const Points& points,
+                                std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateJacobianAt(points[q], out.begin()+q*size());
     }
 
     /** \brief Evaluate partial derivatives of any order of all shape functions
@@ -132,6 +129,49 @@ namespace Dune
     {
       return 1;
     }
+
+  private:
+    // Evaluate all shape functions at one point, writing to out[0],...,out[size()-1]
+    template<class Iterator>
+    void evaluateFunctionAt (const typename Traits::DomainType& in, Iterator out) const
+    {
+      for (size_t i=0; i<size(); i++) {
+
+        out[i] = 1;
+
+        for (int j=0; j<dim; j++)
+          // if j-th bit of i is set multiply with in[j], else with 1-in[j]
+          out[i] *= (i & (1<<j)) ? in[j] :  1-in[j];
+
+      }
+    }
+
+    // Evaluate all Jacobians at one point, writing to out[0],...,out[size()-1]
+    template<class Iterator>
+    void evaluateJacobianAt (const typename Traits::DomainType& in, Iterator out) const
+    {
+      // Loop over all shape functions
+      for (size_t i=0; i<size(); i++) {
+
+        // Loop over all coordinate directions
+        for (int j=0; j<dim; j++) {
+
+          // Initialize: the overall expression is a product
+          // if j-th bit of i is set to -1, else 1
+          out[i][0][j] = (i & (1<<j)) ? 1 : -1;
+
+          for (int k=0; k<dim; k++) {
+
+            if (j!=k)
+              // if k-th bit of i is set multiply with in[j], else with 1-in[j]
+              out[i][0][j] *= (i & (1<<k)) ? in[k] :  1-in[k];
+
+          }
+
+        }
+
+      }
+    }
   };
 }
 #endif
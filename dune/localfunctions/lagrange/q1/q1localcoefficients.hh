@@ -4,8 +4,8 @@
 #define DUNE_Q1_LOCALCOEFFICIENTS_HH
 
 #include <cstddef>
+#include <array>
 #include <iostream>
-#include <vector>
 
 #include <dune/localfunctions/common/localkey.hh>
 
@@ -23,14 +23,14 @@ namespace Dune
   {
   public:
     //! \brief Standard constructor
-    Q1LocalCoefficients () : li(1<<dim)
+    Q1LocalCoefficients ()
     {
       for (std::size_t i=0; i<(1<<dim); i++)
         li[i] = LocalKey(i,dim,0);
     }
 
     //! number of coefficients
-    std::size_t size () const
+    static constexpr std::size_t size ()
     {
       return 1<<dim;
     }
@@ -42,7 +42,7 @@ namespace Dune
     }
 
   private:
-    std::vector<LocalKey> li;
+    std::array<LocalKey,(1<<dim)> li;
   };
 
 }
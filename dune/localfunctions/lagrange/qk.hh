@@ -17,11 +17,12 @@ namespace Dune
    * \tparam R type used for function values
    * \tparam d dimension of the reference element
    * \tparam k polynomial order
+   * \tparam Nodes policy for the one-dimensional nodes, see QkEquidistantNodes
    */
-  template<class D, class R, int d, int k>
+  template<class D, class R, int d, int k, class Nodes = QkEquidistantNodes<k> >
   class QkLocalFiniteElement {
 
-    typedef QkLocalBasis<D,R,k,d> LocalBasis;
+    typedef QkLocalBasis<D,R,k,d,Nodes> LocalBasis;
     typedef QkLocalCoefficients<k,d> LocalCoefficients;
     typedef QkLocalInterpolation<k,d,LocalBasis> LocalInterpolation;
 
@@ -84,6 +85,20 @@ namespace Dune
     GeometryType gt;
   };
 
+  /** \brief Lagrange finite element for cubes with the Gauss-Lobatto points as nodes
+   *
+   * The nodes are the tensor products of the Gauss-Lobatto points of order k,
+   * i.e., the points of the Gauss-Lobatto quadrature rule of that order.
+   * Using this rule for the mass matrix makes it diagonal (mass lumping).
+   *
+   * \tparam D type used for domain coordinates
+   * \tparam R type used for function values
+   * \tparam d dimension of the reference element
+   * \tparam k polynomial order
+   */
+  template<class D, class R, int d, int k>
+  using QkGaussLobattoLocalFiniteElement = QkLocalFiniteElement<D,R,d,k,QkGaussLobattoNodes<k> >;
+
 }
 
 #endif
@@ -4,7 +4,12 @@
 #ifndef DUNE_LOCALFUNCTIONS_QKLOCALBASIS_HH
 #define DUNE_LOCALFUNCTIONS_QKLOCALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
@@ -14,125 +19,553 @@
 
 #include <dune/localfunctions/common/localbasis.hh>
 #include <dune/localfunctions/common/localfiniteelementtraits.hh>
+#include <dune/localfunctions/lagrange/gausslobattopoints.hh>
 
 
 namespace Dune
 {
+  /** \brief Equidistant nodes i/k of the one-dimensional Lagrange polynomials of QkLocalBasis
+   *
+   * A node policy provides the positions of the nodes and the linear
+   * factors \f$(x-x_j)/(x_i-x_j)\f$ of the Lagrange polynomial i, as
+   * well as their derivatives.
+   */
+  template<int k>
+  struct QkEquidistantNodes
+  {
+    //! \brief Position of node i in [0,1]
+    static double node (int i)
+    {
+      return (1.0*i)/k;
+    }
+
+    //! \brief The factor (x-x_j)/(x_i-x_j) of the Lagrange polynomial i
+    template<class R, class D>
+    static R factor (const D& x, int i, int j)
+    {
+      // convert explicitly, so that vectorized field types need
+      // no mixed arithmetic with int
+      return (R(k)*x - R(j))/R(i-j);
+    }
+
+    //! \brief The derivative of factor(x,i,j)
+    template<class R>
+    static R slope (int i, int j)
+    {
+      return R(k)/R(i-j);
+    }
+  };
+
+  /** \brief Gauss-Lobatto-Legendre nodes of the one-dimensional Lagrange polynomials of QkLocalBasis
+   *
+   * With these nodes and the Gauss-Lobatto quadrature rule of order k the
+   * mass matrix of the Qk element is diagonal.  The nodes are computed once
+   * per order, see GaussLobattoPoints.
+   */
+  template<int k>
+  struct QkGaussLobattoNodes
+  {
+    //! \brief Position of node i in [0,1]
+    static double node (int i)
+    {
+      return nodes()[i];
+    }
+
+    //! \brief The factor (x-x_j)/(x_i-x_j) of the Lagrange polynomial i
+    template<class R, class D>
+    static R factor (const D& x, int i, int j)
+    {
+      const double scale = 1.0/(node(i) - node(j));
+      return R(scale)*x - R(scale*node(j));
+    }
+
+    //! \brief The derivative of factor(x,i,j)
+    template<class R>
+    static R slope (int i, int j)
+    {
+      return R(1.0/(node(i) - node(j)));
+    }
+
+  private:
+    static const std::vector<double>& nodes ()
+    {
+      static const std::vector<double> points = GaussLobattoPoints<double>(k).points();
+      return points;
+    }
+  };
+
   /**@ingroup LocalBasisImplementation
      \brief Lagrange shape functions of order k on the reference cube.
 
      Also known as \f$Q^k\f$.
 
+     The shape functions are products of one-dimensional Lagrange
+     polynomials.  All evaluation methods therefore first tabulate the
+     k+1 one-dimensional polynomials (and derivatives) once per direction
+     and then form the tensor products, which costs O(k^d) per point.
+
+     In addition to the usual interface the basis can be evaluated on
+     tensor-product grids of points.  Linear combinations of the shape
+     functions are then evaluated by sum factorization in
+     O(d k^(d+1)) operations.
+
+     The nodes of the one-dimensional Lagrange polynomials are given by a
+     node policy, by default the equidistant nodes i/k.  With the policy
+     QkGaussLobattoNodes the nodes are the Gauss-Lobatto points, which keeps
+     the basis well conditioned for high orders and, combined with the
+     Gauss-Lobatto quadrature, yields a diagonal mass matrix.
+
      \tparam D Type to represent the field in the domain.
      \tparam R Type to represent the field in the range.
      \tparam k Polynomial degree
      \tparam d Dimension of the cube
+     \tparam Nodes Policy for the nodes in one dimension, see QkEquidistantNodes
 
      \nosubgrouping
    */
-  template<class D, class R, int k, int d>
+  template<class D, class R, int k, int d, class Nodes = QkEquidistantNodes<k> >
   class QkLocalBasis
   {
     enum { n = StaticPower<k+1,d>::power };
 
-    // ith Lagrange polynomial of degree k in one dimension
-    static R p (int i, D x)
+    // Values and first derivatives of all Lagrange polynomials
+    // of degree k in one dimension at the point x
+    static void tabulate (const D& x, R* values, R* derivatives)
     {
-      R result(1.0);
-      for (int j=0; j<=k; j++)
-        if (j!=i) result *= (k*x-j)/(i-j);
-      return result;
+      for (int i=0; i<=k; i++)
+      {
+        // product rule, applied factor by factor
+        R value(1.0), derivative(0.0);
+        for (int j=0; j<=k; j++)
+          if (j!=i)
+          {
+            const R factor = Nodes::template factor<R>(x, i, j);
+            derivative = derivative*factor + value*Nodes::template slope<R>(i, j);
+            value *= factor;
+          }
+        values[i] = value;
+        derivatives[i] = derivative;
+      }
     }
 
-    // derivative of ith Lagrange polynomial of degree k in one dimension
-    static R dp (int i, D x)
+    // Derivatives up to order maxOrder of all Lagrange polynomials of
+    // degree k in one dimension at the point x, the s-th derivative of
+    // polynomial i is stored at table[s*(k+1)+i]
+    static void tabulate (const D& x, unsigned int maxOrder, R* table)
     {
-      R result(0.0);
+      for (int i=0; i<=k; i++)
+      {
+        // Leibniz rule, applied factor by factor
+        R* column = table + i;
+        column[0] = R(1.0);
+        for (unsigned int s=1; s<=maxOrder; s++)
+          column[s*(k+1)] = R(0.0);
+        for (int j=0; j<=k; j++)
+          if (j!=i)
+          {
+            const R factor = Nodes::template factor<R>(x, i, j);
+            const R slope = Nodes::template slope<R>(i, j);
+            for (unsigned int s=maxOrder; s>0; s--)
+              column[s*(k+1)] = column[s*(k+1)]*factor + R(s)*slope*column[(s-1)*(k+1)];
+            column[0] *= factor;
+          }
+      }
+    }
 
-      for (int j=0; j<=k; j++)
-        if (j!=i)
-        {
-          R prod( (k*1.0)/(i-j) );
-          for (int l=0; l<=k; l++)
-            if (l!=i && l!=j)
-              prod *= (k*x-l)/(i-l);
-          result += prod;
-        }
-      return result;
+    // Tabulate the one-dimensional polynomials at the points of each direction,
+    // the entry for point q and polynomial i is stored at q*(k+1)+i
+    static void tabulate (const std::array<std::vector<D>,d>& points,
+                          std::array<std::vector<R>,d>& values,
+                          std::array<std::vector<R>,d>& derivatives)
+    {
+      for (int j=0; j<d; j++)
+      {
+        values[j].resize(points[j].size()*(k+1));
+        derivatives[j].resize(points[j].size()*(k+1));
+        for (std::size_t q=0; q<points[j].size(); q++)
+          tabulate(points[j][q], &(values[j][q*(k+1)]), &(derivatives[j][q*(k+1)]));
+      }
     }
 
-    // Return i as a d-digit number in the (k+1)-nary system
-    static Dune::FieldVector<int,d> multiindex (int i)
+    // Form all products of the one-dimensional tables, storing the product for
+    // shape function i in value(i).  The first direction runs fastest.
+    template<class Value>
+    static void tensorProduct (const std::array<const R*,d>& tables, Value&& value)
     {
-      Dune::FieldVector<int,d> alpha;
+      value(0) = R(1.0);
+      std::size_t blockSize = 1;
       for (int j=0; j<d; j++)
       {
-        alpha[j] = i % (k+1);
-        i = i/(k+1);
+        // run backwards, so that the entries of the previous block are still
+        // available when they are overwritten
+        for (int a=k; a>=0; a--)
+          for (std::size_t i=0; i<blockSize; i++)
+            value(a*blockSize+i) = value(i)*tables[j][a];
+        blockSize *= k+1;
       }
-      return alpha;
+    }
+
+    // Contract the coefficient tensor with one table per direction (sum factorization),
+    // table j holds numPoints[j] rows of k+1 entries
+    template<class Coefficients>
+    static void sumFactorization (const std::array<const std::vector<R>*,d>& tables,
+                                  const std::array<std::size_t,d>& numPoints,
+                                  const Coefficients& coefficients,
+                                  std::vector<R>& result)
+    {
+      std::vector<R> current(n), next;
+      for (std::size_t i=0; i<n; i++)
+        current[i] = coefficients[i];
+
+      // the current tensor is indexed by (q_0,...,q_{j-1},a_j,...,a_{d-1})
+      std::size_t inner = 1;
+      std::size_t outer = n/(k+1);
+      for (int j=0; j<d; j++)
+      {
+        const std::vector<R>& table = *tables[j];
+        next.assign(inner*numPoints[j]*outer, R(0.0));
+        for (std::size_t o=0; o<outer; o++)
+          for (std::size_t q=0; q<numPoints[j]; q++)
+            for (int a=0; a<=k; a++)
+            {
+              const R factor = table[q*(k+1)+a];
+              const R* source = &(current[inner*(a+(k+1)*o)]);
+              R* target = &(next[inner*(q+numPoints[j]*o)]);
+              for (std::size_t i=0; i<inner; i++)
+                target[i] += factor*source[i];
+            }
+        std::swap(current, next);
+        inner *= numPoints[j];
+        outer /= k+1;
+      }
+      std::swap(result, current);
     }
 
   public:
-    typedef LocalBasisTraits<D,d,Dune::FieldVector<D,d>,R,1,Dune::FieldVector<R,1>,Dune::FieldMatrix<R,1,d>, 1> Traits;
+    typedef LocalBasisTraits<D,d,Dune::FieldVector<D,d>,R,1,Dune::FieldVector<R,1>,Dune::FieldMatrix<R,1,d>, 2> Traits;
 
     //! \brief number of shape functions
-    unsigned int size () const
+    static constexpr unsigned int size ()
     {
       return StaticPower<k+1,d>::power;
     }
 
     //! \brief Evaluate all shape functions
-    inline void evaluateFunction (const typename Traits::DomainType& in,
-                                  std::vector<typename Traits::RangeType>& out) const
+    template<class Out>
+    void evaluateFunction (const typename Traits::DomainType& in,
+                           Out& out) const
     {
-      out.resize(size());
-      for (size_t i=0; i<size(); i++)
-      {
-        // convert index i to multiindex
-        Dune::FieldVector<int,d> alpha(multiindex(i));
-
-        // initialize product
-        out[i] = 1.0;
+      Impl::resizeOutput(out, size());
+      evaluateFunctionAt(in, out.begin());
+    }
 
-        // dimension by dimension
-        for (int j=0; j<d; j++)
-          out[i] *= p(alpha[j],in[j]);
-      }
+    /** \brief Evaluate all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Values, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateFunctionBatch (const Points& points,
+                                std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateFunctionAt(points[q], out.begin()+q*size());
     }
 
     /** \brief Evaluate Jacobian of all shape functions
      * \param in position where to evaluate
      * \param out The return value
      */
-    inline void
+    template<class Out>
+    void
     evaluateJacobian (const typename Traits::DomainType& in,
-                      std::vector<typename Traits::JacobianType>& out) const
+                      Out& out) const
     {
-      out.resize(size());
+      Impl::resizeOutput(out, size());
+      evaluateJacobianAt(in, out.begin());
+    }
+
+    /** \brief Evaluate Jacobian of all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Jacobians, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateJacobianBatch (const Points& points,
+                                std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*size());
+      for (std::size_t q=0; q<points.size(); q++)
+        evaluateJacobianAt(points[q], out.begin()+q*size());
+    }
+
+    /** \brief Evaluate the second derivatives of all shape functions
+     *
+     * The one-dimensional polynomials and their first two derivatives are
+     * tabulated once per direction, every entry of the Hessians is a tensor
+     * product of these tables.
+     *
+     * \param in Position where to evaluate the derivatives
+     * \param[out] out Hessians, see LocalBasisTraits::HessianType
+     */
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& in,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, size());
+
+      std::array<std::array<R,3*(k+1)>,d> derivatives;
+      for (int j=0; j<d; j++)
+        tabulate(in[j], 2, derivatives[j].data());
+
+      std::array<const R*,d> tables;
+      for (int a=0; a<d; a++)
+        for (int b=a; b<d; b++)
+        {
+          for (int j=0; j<d; j++)
+            tables[j] = derivatives[j].data() + ((j==a) + (j==b))*(k+1);
+          tensorProduct(tables, [&](std::size_t i) -> R& { return out[i][0][a][b]; });
+          if (b != a)
+            for (std::size_t i=0; i<size(); i++)
+              out[i][0][b][a] = out[i][0][a][b];
+        }
+    }
 
-      // Loop over all shape functions
-      for (size_t i=0; i<size(); i++)
+    /** \brief Multi-indices of the partial derivatives computed by evaluatePartials
+     *
+     * The multi-indices are sorted by their total order.  Those of the same
+     * total order are numbered like the shape functions, i.e., the first
+     * direction runs fastest.
+     *
+     * \param maxOrder Highest total order of the derivatives
+     */
+    static std::vector<std::array<unsigned int,d> > partialOrders (unsigned int maxOrder)
+    {
+      std::vector<std::array<unsigned int,d> > result;
+      std::array<unsigned int,d> order;
+      for (unsigned int totalOrder=0; totalOrder<=maxOrder; totalOrder++)
       {
-        // convert index i to multiindex
-        Dune::FieldVector<int,d> alpha(multiindex(i));
+        order.fill(0);
+        while (true)
+        {
+          if (std::accumulate(order.begin(), order.end(), 0u) == totalOrder)
+            result.push_back(order);
 
-        // Loop over all coordinate directions
+          int j = 0;
+          for (; j<d; j++)
+          {
+            if (++order[j] <= totalOrder)
+              break;
+            order[j] = 0;
+          }
+          if (j == d)
+            break;
+        }
+      }
+      return result;
+    }
+
+    /** \brief Evaluate all partial derivatives up to a given total order
+     *
+     * The one-dimensional derivative tables up to order maxOrder are computed
+     * once per direction; each partial derivative of the shape functions is
+     * then a tensor product of rows of these tables.
+     *
+     * \param maxOrder Highest total order of the derivatives
+     * \param in Position where to evaluate the derivatives
+     * \param[out] out out[l*size()+i] is the partial derivative of shape
+     *             function i with the multi-index partialOrders(maxOrder)[l]
+     */
+    void evaluatePartials (unsigned int maxOrder,
+                           const typename Traits::DomainType& in,
+                           std::vector<typename Traits::RangeType>& out) const
+    {
+      const std::vector<std::array<unsigned int,d> > orders = partialOrders(maxOrder);
+      out.resize(orders.size()*size());
+
+      // derivatives of an order beyond k vanish
+      const unsigned int tableOrder = std::min<unsigned int>(maxOrder, k);
+      std::array<std::vector<R>,d> derivatives;
+      for (int j=0; j<d; j++)
+      {
+        derivatives[j].resize((tableOrder+1)*(k+1));
+        tabulate(in[j], tableOrder, derivatives[j].data());
+      }
+
+      std::array<const R*,d> tables;
+      for (std::size_t l=0; l<orders.size(); l++)
+      {
+        auto block = out.begin() + l*size();
+        if (*std::max_element(orders[l].begin(), orders[l].end()) > tableOrder)
+        {
+          std::fill(block, block + size(), typename Traits::RangeType(R(0.0)));
+          continue;
+        }
+        for (int j=0; j<d; j++)
+          tables[j] = derivatives[j].data() + orders[l][j]*(k+1);
+        tensorProduct(tables, [&](std::size_t i) -> R& { return block[i][0]; });
+      }
+    }
+
+    /** \brief Evaluate all shape functions on a tensor-product grid of points
+     *
+     * The grid consists of all points whose j-th coordinate is taken from
+     * points1D[j].  Grid points are numbered like the shape functions, i.e.,
+     * the point with coordinates (points1D[0][q_0],...,points1D[d-1][q_{d-1}])
+     * has the index q = q_0 + m_0*(q_1 + m_1*(...)), where m_j = points1D[j].size().
+     *
+     * \param points1D The coordinates of the grid in each direction
+     * \param[out] out Values, out[q*size()+i] belongs to shape function i at grid point q
+     */
+    void evaluateFunctionTensorGrid (const std::array<std::vector<D>,d>& points1D,
+                                     std::vector<typename Traits::RangeType>& out) const
+    {
+      std::array<std::vector<R>,d> values, derivatives;
+      tabulate(points1D, values, derivatives);
+
+      std::size_t numPoints = 1;
+      for (int j=0; j<d; j++)
+        numPoints *= points1D[j].size();
+      out.resize(numPoints*size());
+
+      std::array<std::size_t,d> index;
+      std::fill(index.begin(), index.end(), 0);
+      std::array<const R*,d> tables;
+      for (std::size_t q=0; q<numPoints; q++)
+      {
+        for (int j=0; j<d; j++)
+          tables[j] = &(values[j][index[j]*(k+1)]);
+        auto block = out.begin()+q*size();
+        tensorProduct(tables, [&](std::size_t i) -> R& { return block[i][0]; });
+
+        // increment the grid index
         for (int j=0; j<d; j++)
         {
-          // Initialize: the overall expression is a product
-          // if j-th bit of i is set to -1, else 1
-          out[i][0][j] = dp(alpha[j],in[j]);
-
-          // rest of the product
-          for (int l=0; l<d; l++)
-            if (l!=j)
-              out[i][0][j] *= p(alpha[l],in[l]);
+          if (++index[j] < points1D[j].size())
+            break;
+          index[j] = 0;
         }
       }
     }
 
+    /** \brief Evaluate the Jacobians of all shape functions on a tensor-product grid of points
+     *
+     * See evaluateFunctionTensorGrid for the numbering of the grid points.
+     *
+     * \param points1D The coordinates of the grid in each direction
+     * \param[out] out Jacobians, out[q*size()+i] belongs to shape function i at grid point q
+     */
+    void evaluateJacobianTensorGrid (const std::array<std::vector<D>,d>& points1D,
+                                     std::vector<typename Traits::JacobianType>& out) const
+    {
+      std::array<std::vector<R>,d> values, derivatives;
+      tabulate(points1D, values, derivatives);
+
+      std::size_t numPoints = 1;
+      for (int j=0; j<d; j++)
+        numPoints *= points1D[j].size();
+      out.resize(numPoints*size());
+
+      std::array<std::size_t,d> index;
+      std::fill(index.begin(), index.end(), 0);
+      std::array<const R*,d> tables;
+      for (std::size_t q=0; q<numPoints; q++)
+      {
+        auto block = out.begin()+q*size();
+        for (int m=0; m<d; m++)
+        {
+          for (int j=0; j<d; j++)
+            tables[j] = (j==m) ? &(derivatives[j][index[j]*(k+1)]) : &(values[j][index[j]*(k+1)]);
+          tensorProduct(tables, [&](std::size_t i) -> R& { return block[i][0][m]; });
+        }
+
+        // increment the grid index
+        for (int j=0; j<d; j++)
+        {
+          if (++index[j] < points1D[j].size())
+            break;
+          index[j] = 0;
+        }
+      }
+    }
+
+    /** \brief Evaluate a linear combination of the shape functions on a tensor-product grid
+     *
+     * The function \f$ u = \sum_i c_i \hat\phi_i \f$ is evaluated by sum factorization,
+     * i.e., by contracting the coefficients with the one-dimensional polynomials one
+     * direction at a time.  See evaluateFunctionTensorGrid for the numbering of the
+     * grid points.
+     *
+     * \param points1D The coordinates of the grid in each direction
+     * \param coefficients The coefficients \f$ c_i \f$, one per shape function
+     * \param[out] out Values of u, out[q] belongs to grid point q
+     */
+    template<class Coefficients>
+    void evaluateFunctionTensorGrid (const std::array<std::vector<D>,d>& points1D,
+                                     const Coefficients& coefficients,
+                                     std::vector<typename Traits::RangeType>& out) const
+    {
+      std::array<std::vector<R>,d> values, derivatives;
+      tabulate(points1D, values, derivatives);
+
+      std::array<const std::vector<R>*,d> tables;
+      std::array<std::size_t,d> numPoints;
+      for (int j=0; j<d; j++)
+      {
+        tables[j] = &(values[j]);
+        numPoints[j] = points1D[j].size();
+      }
+
+      std::vector<R> result;
+      sumFactorization(tables, numPoints, coefficients, result);
+
+      out.resize(result.size());
+      for (std::size_t q=0; q<result.size(); q++)
+        out[q] = result[q];
+    }
+
+    /** \brief Evaluate the Jacobian of a linear combination of the shape functions on a tensor-product grid
+     *
+     * Each partial derivative is evaluated by sum factorization.  See
+     * evaluateFunctionTensorGrid for the numbering of the grid points.
+     *
+     * \param points1D The coordinates of the grid in each direction
+     * \param coefficients The coefficients \f$ c_i \f$, one per shape function
+     * \param[out] out Jacobians of u, out[q] belongs to grid point q
+     */
+    template<class Coefficients>
+    void evaluateJacobianTensorGrid (const std::array<std::vector<D>,d>& points1D,
+                                     const Coefficients& coefficients,
+                                     std::vector<typename Traits::JacobianType>& out) const
+    {
+      std::array<std::vector<R>,d> values, derivatives;
+      tabulate(points1D, values, derivatives);
+
+      std::size_t total = 1;
+      std::array<std::size_t,d> numPoints;
+      for (int j=0; j<d; j++)
+      {
+        numPoints[j] = points1D[j].size();
+        total *= numPoints[j];
+      }
+      out.resize(total);
+
+      std::array<const std::vector<R>*,d> tables;
+      std::vector<R> result;
+      for (int m=0; m<d; m++)
+      {
+        for (int j=0; j<d; j++)
+          tables[j] = (j==m) ? &(derivatives[j]) : &(values[j]);
+        sumFactorization(tables, numPoints, coefficients, result);
+        for (std::size_t q=0; q<total; q++)
+          out[q][0][m] = result[q];
+      }
+    }
+
     /** \brief Evaluate partial derivatives of any order of all shape functions
+     *
+     * The one-dimensional polynomials are differentiated order[j] times in
+     * direction j, so any mixed derivative is a single tensor product.
+     *
      * \param order Order of the partial derivatives, in the classic multi-index notation
      * \param in Position where to evaluate the derivatives
      * \param[out] out Return value: the desired partial derivatives
@@ -141,35 +574,24 @@ namespace Dune
                         const typename Traits::DomainType& in,
                         std::vector<typename Traits::RangeType>& out) const
     {
-      auto totalOrder = std::accumulate(order.begin(), order.end(), 0);
+      out.resize(size());
 
-      switch (totalOrder)
+      // derivatives of an order beyond k vanish
+      if (*std::max_element(order.begin(), order.end()) > unsigned(k))
       {
-        case 0:
-          evaluateFunction(in,out);
-          break;
-        case 1:
-        {
-          out.resize(size());
-
-          // Loop over all shape functions
-          for (size_t i=0; i<size(); i++)
-          {
-            // convert index i to multiindex
-            Dune::FieldVector<int,d> alpha(multiindex(i));
-
-            // Initialize: the overall expression is a product
-            out[i][0] = 1.0;
+        std::fill(out.begin(), out.end(), typename Traits::RangeType(R(0.0)));
+        return;
+      }
 
-            // rest of the product
-            for (std::size_t l=0; l<d; l++)
-              out[i][0] *= (order[l]) ? dp(alpha[l],in[l]) : p(alpha[l],in[l]);
-          }
-          break;
-        }
-        default:
-          DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+      std::array<std::array<R,(k+1)*(k+1)>,d> derivatives;
+      std::array<const R*,d> tables;
+      for (int j=0; j<d; j++)
+      {
+        tabulate(in[j], order[j], derivatives[j].data());
+        tables[j] = derivatives[j].data() + order[j]*(k+1);
       }
+
+      tensorProduct(tables, [&](std::size_t i) -> R& { return out[i][0]; });
     }
 
     //! \brief Polynomial order of the shape functions
@@ -177,6 +599,46 @@ namespace Dune
     {
       return k;
     }
+
+    //! \brief Position of the i-th node of the one-dimensional Lagrange polynomials
+    static double lagrangeNode (int i)
+    {
+      return Nodes::node(i);
+    }
+
+  private:
+    // Evaluate all shape functions at one point, writing to out[0],...,out[n-1]
+    template<class Iterator>
+    void evaluateFunctionAt (const typename Traits::DomainType& in, Iterator out) const
+    {
+      std::array<std::array<R,k+1>,d> values, derivatives;
+      std::array<const R*,d> tables;
+      for (int j=0; j<d; j++)
+      {
+        tabulate(in[j], values[j].data(), derivatives[j].data());
+        tables[j] = values[j].data();
+      }
+
+      tensorProduct(tables, [&](std::size_t i) -> R& { return out[i][0]; });
+    }
+
+    // Evaluate all Jacobians at one point, writing to out[0],...,out[n-1]
+    template<class Iterator>
+    void evaluateJacobianAt (const typename Traits::DomainType& in, Iterator out) const
+    {
+      std::array<std::array<R,k+1>,d> values, derivatives;
+      for (int j=0; j<d; j++)
+        tabulate(in[j], values[j].data(), derivatives[j].data());
+
+      // the derivative in direction m uses the derivative table in that direction
+      std::array<const R*,d> tables;
+      for (int m=0; m<d; m++)
+      {
+        for (int j=0; j<d; j++)
+          tables[j] = (j==m) ? derivatives[j].data() : values[j].data();
+        tensorProduct(tables, [&](std::size_t i) -> R& { return out[i][0][m]; });
+      }
+    }
   };
 }
 
@@ -6,7 +6,6 @@
 
 #include <array>
 #include <cassert>
-#include <vector>
 
 #include <dune/common/exceptions.hh>
 #include <dune/common/power.hh>
@@ -25,6 +24,8 @@ namespace Dune
 
     static const unsigned unsignedK = k;
 
+    typedef std::array<unsigned int,StaticPower<k+1,d>::power> IndexArray;
+
     // Return i as a d-digit number in the (k+1)-nary system
     static std::array<unsigned int,d> multiindex (unsigned int i)
     {
@@ -38,7 +39,7 @@ namespace Dune
     }
 
     /** \brief Set the 'subentity' field for each dof for a 1d element */
-    void setup1d(std::vector<unsigned int>& subEntity)
+    void setup1d(IndexArray& subEntity)
     {
       // Special-handling for piecewise constant elements
       if (k==0)
@@ -63,7 +64,7 @@ namespace Dune
       assert((StaticPower<k+1,d>::power==lastIndex));
     }
 
-    void setup2d(std::vector<unsigned int>& subEntity)
+    void setup2d(IndexArray& subEntity)
     {
       // Special-handling for piecewise constant elements
       if (k==0)
@@ -112,7 +113,7 @@ namespace Dune
 
 
 
-    void setup3d(std::vector<unsigned int>& subEntity)
+    void setup3d(IndexArray& subEntity)
     {
       // Special-handling for piecewise constant elements
       if (k==0)
@@ -222,10 +223,10 @@ namespace Dune
 
   public:
     //! \brief Default constructor
-    QkLocalCoefficients () : li(StaticPower<k+1,d>::power)
+    QkLocalCoefficients ()
     {
       // Set up array of codimension-per-dof-number
-      std::vector<unsigned int> codim(li.size());
+      IndexArray codim;
 
       for (std::size_t i=0; i<codim.size(); i++) {
         codim[i] = 0;
@@ -244,7 +245,7 @@ namespace Dune
       // To make it consecutive we interpret 'i' in the (k+1)-adic system, omit all digits
       // that correspond to axes where the dof is on the element boundary, and transform the
       // rest to the (k-1)-adic system.
-      std::vector<unsigned int> index(size());
+      IndexArray index;
 
       for (std::size_t i=0; i<size(); i++) {
 
@@ -259,7 +260,7 @@ namespace Dune
       }
 
       // Set up entity and dof numbers for each (supported) dimension separately
-      std::vector<unsigned int> subEntity(li.size());
+      IndexArray subEntity;
 
       if (k==1) {  // We can handle the first-order case in any dimension
 
@@ -286,7 +287,7 @@ namespace Dune
     }
 
     //! number of coefficients
-    std::size_t size () const
+    static constexpr std::size_t size ()
     {
       return StaticPower<k+1,d>::power;
     }
@@ -298,7 +299,7 @@ namespace Dune
     }
 
   private:
-    std::vector<LocalKey> li;
+    std::array<LocalKey,StaticPower<k+1,d>::power> li;
   };
 
 }
@@ -50,7 +50,7 @@ namespace Dune
 
         // Generate coordinate of the i-th Lagrange point
         for (int j=0; j<d; j++)
-          x[j] = (1.0*alpha[j])/k;
+          x[j] = LB::lagrangeNode(alpha[j]);
 
         f.evaluate(x,y); out[i] = y;
       }
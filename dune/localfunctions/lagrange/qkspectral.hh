@@ -0,0 +1,201 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef DUNE_LOCALFUNCTIONS_QK_SPECTRALLOCALFINITEELEMENT_HH
+#define DUNE_LOCALFUNCTIONS_QK_SPECTRALLOCALFINITEELEMENT_HH
+
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/power.hh>
+
+#include <dune/localfunctions/lagrange/gausslobattopoints.hh>
+#include <dune/localfunctions/lagrange/qk.hh>
+
+namespace Dune
+{
+  /** \brief Spectral element: Lagrange element on cubes collocated with the Gauss-Lobatto quadrature
+   *
+   * The nodes of the shape functions are the points of the Gauss-Lobatto
+   * quadrature rule of order k, which is exact for polynomials of degree
+   * 2k-1 in each direction.  Using this rule, the values of the shape
+   * functions at the quadrature points form the identity, so the
+   * coefficients of a discrete function are its values at the quadrature
+   * points and the mass matrix is the diagonal of the quadrature weights.
+   *
+   * Besides the usual interface the element therefore only needs the
+   * one-dimensional quadrature weights and the (k+1)x(k+1) differentiation
+   * matrix, which are computed once per order and shared by all elements.
+   * The gradient of a discrete function at all quadrature points and the
+   * transposed operation are applied by sum factorization in
+   * O(d k^(d+1)) operations.  Applying the reference stiffness matrix, for
+   * instance, reads
+   * \code
+   * fe.gradient(u, g);
+   * for (std::size_t q=0; q<g.size(); q++)
+   *   g[q] *= fe.weight(q);
+   * fe.gradientTransposed(g, result);
+   * \endcode
+   *
+   * Nodes, shape functions and quadrature points are numbered with the
+   * first direction running fastest.
+   *
+   * \tparam D type used for domain coordinates
+   * \tparam R type used for function values
+   * \tparam d dimension of the reference element
+   * \tparam k polynomial order, at least 1
+   */
+  template<class D, class R, int d, int k>
+  class QkSpectralLocalFiniteElement
+    : public QkLocalFiniteElement<D,R,d,k,QkGaussLobattoNodes<k> >
+  {
+    static_assert(k >= 1, "The spectral element needs at least two Gauss-Lobatto points");
+
+    enum { n = StaticPower<k+1,d>::power };
+
+  public:
+    //! \brief Gradient with respect to the reference coordinates
+    typedef FieldVector<R,d> Gradient;
+
+    //! \brief The Gauss-Lobatto points of order k on [0,1], i.e., the one-dimensional nodes
+    static const std::vector<R>& points1D ()
+    {
+      return data().points;
+    }
+
+    //! \brief The weights of the Gauss-Lobatto quadrature rule of order k on [0,1]
+    static const std::vector<R>& weights1D ()
+    {
+      return data().weights;
+    }
+
+    /** \brief The one-dimensional differentiation matrix
+     *
+     * The entry q*(k+1)+i is the derivative of the one-dimensional Lagrange
+     * polynomial i at the Gauss-Lobatto point q.
+     */
+    static const std::vector<R>& differentiationMatrix1D ()
+    {
+      return data().derivatives;
+    }
+
+    /** \brief Quadrature weight of the node i
+     *
+     * This is the diagonal entry i of the mass matrix on the reference element.
+     */
+    static R weight (std::size_t i)
+    {
+      const std::vector<R>& weights = weights1D();
+      R result = weights[i%(k+1)];
+      for (int j=1; j<d; j++)
+      {
+        i /= k+1;
+        result *= weights[i%(k+1)];
+      }
+      return result;
+    }
+
+    /** \brief Gradient of a discrete function at all nodes
+     *
+     * \param coefficients The coefficients of the function, i.e., its values at the nodes
+     * \param[out] out The reference gradients, out[q] belongs to node q
+     */
+    template<class Coefficients>
+    static void gradient (const Coefficients& coefficients, std::vector<Gradient>& out)
+    {
+      const std::vector<R>& derivatives = differentiationMatrix1D();
+      out.resize(n);
+      std::size_t stride = 1;
+      for (int m=0; m<d; m++)
+      {
+        for (std::size_t q=0; q<n; q++)
+        {
+          const std::size_t qm = (q/stride)%(k+1);
+          const std::size_t base = q - qm*stride;
+          R sum(0.0);
+          for (int a=0; a<=k; a++)
+            sum += derivatives[qm*(k+1)+a]*coefficients[base+a*stride];
+          out[q][m] = sum;
+        }
+        stride *= k+1;
+      }
+    }
+
+    /** \brief Apply the transpose of gradient()
+     *
+     * Computes \f$ r_i = \sum_q g_q \cdot \nabla\hat\phi_i(x_q) \f$ for
+     * vectors \f$ g_q \f$ given at the nodes.
+     *
+     * \param gradients The vectors \f$ g_q \f$, one per node
+     * \param[out] out The result, out[i] belongs to shape function i
+     */
+    static void gradientTransposed (const std::vector<Gradient>& gradients, std::vector<R>& out)
+    {
+      const std::vector<R>& derivatives = differentiationMatrix1D();
+      out.assign(n, R(0.0));
+      std::size_t stride = 1;
+      for (int m=0; m<d; m++)
+      {
+        for (std::size_t i=0; i<n; i++)
+        {
+          const std::size_t im = (i/stride)%(k+1);
+          const std::size_t base = i - im*stride;
+          R sum(0.0);
+          for (int b=0; b<=k; b++)
+            sum += derivatives[b*(k+1)+im]*gradients[base+b*stride][m];
+          out[i] += sum;
+        }
+        stride *= k+1;
+      }
+    }
+
+    QkSpectralLocalFiniteElement* clone () const
+    {
+      return new QkSpectralLocalFiniteElement(*this);
+    }
+
+  private:
+    struct Data
+    {
+      Data ()
+      {
+        // computed in R, so that multi-precision fields obtain accurate
+        // points, weights, and derivatives
+        const GaussLobattoPoints<R> gaussLobatto(k);
+        points = gaussLobatto.points();
+        weights = gaussLobatto.weights();
+        const std::vector<R>& x = points;
+
+        // barycentric weights 1/prod_{j!=i}(x_i-x_j) of the Lagrange polynomials
+        std::vector<R> barycentric(k+1, R(1.0));
+        for (int i=0; i<=k; i++)
+          for (int j=0; j<=k; j++)
+            if (j != i)
+              barycentric[i] /= x[i] - x[j];
+
+        // off-diagonal entries from the barycentric formula, the diagonal
+        // ones make the rows sum to zero, since the polynomials sum to one
+        derivatives.assign((k+1)*(k+1), R(0.0));
+        for (int q=0; q<=k; q++)
+          for (int i=0; i<=k; i++)
+            if (i != q)
+            {
+              derivatives[q*(k+1)+i] = barycentric[i]/(barycentric[q]*(x[q] - x[i]));
+              derivatives[q*(k+1)+q] -= derivatives[q*(k+1)+i];
+            }
+      }
+
+      std::vector<R> points, weights, derivatives;
+    };
+
+    static const Data& data ()
+    {
+      static const Data data;
+      return data;
+    }
+  };
+
+}
+
+#endif
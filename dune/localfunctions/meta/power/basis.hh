@@ -11,6 +11,8 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 
+#include <dune/localfunctions/common/localbasis.hh>
+
 namespace Dune {
 
   //! Meta-basis turning a scalar basis into vector-valued basis
@@ -68,7 +70,7 @@ namespace Dune {
     void evaluateFunction(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Range>& out) const
     {
-      std::vector<typename Backend::Traits::Range> backendValues;
+      auto& backendValues = Impl::threadScratch<PowerBasis, typename Backend::Traits::Range>();
       backend->evaluateFunction(in, backendValues);
       out.assign(size(), typename Traits::Range(0));
       for(std::size_t d = 0; d < dimR; ++d)
@@ -80,7 +82,7 @@ namespace Dune {
     void evaluateJacobian(const typename Traits::DomainLocal& in,
                           std::vector<typename Traits::Jacobian>& out) const
     {
-      std::vector<typename Backend::Traits::Jacobian> backendValues;
+      auto& backendValues = Impl::threadScratch<PowerBasis, typename Backend::Traits::Jacobian>();
       backend->evaluateJacobian(in, backendValues);
       out.assign(size(), typename Traits::Jacobian(0));
       for(std::size_t d = 0; d < dimR; ++d)
@@ -5,7 +5,9 @@
 
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <numeric>
+#include <vector>
 
 #include <dune/common/fmatrix.hh>
 
@@ -51,26 +53,35 @@ namespace Dune
     //! Access output vector of evaluateFunction() and evaluate()
     template <typename Traits>
     class EvalAccess {
-      std::vector<typename Traits::RangeType> &out;
+      typedef typename std::vector<typename Traits::RangeType>::iterator Iterator;
+      Iterator out;
+      unsigned int size;
 #ifndef NDEBUG
       unsigned int first_unused_index;
 #endif
 
     public:
       EvalAccess(std::vector<typename Traits::RangeType> &out_)
-        : out(out_)
+        : out(out_.begin()), size(out_.size())
+#ifndef NDEBUG
+          , first_unused_index(0)
+#endif
+      { }
+      //! Access size_ entries starting at out_, used for batched evaluation
+      EvalAccess(Iterator out_, unsigned int size_)
+        : out(out_), size(size_)
 #ifndef NDEBUG
           , first_unused_index(0)
 #endif
       { }
 #ifndef NDEBUG
       ~EvalAccess() {
-        assert(first_unused_index == out.size());
+        assert(first_unused_index == size);
       }
 #endif
       typename Traits::RangeFieldType &operator[](unsigned int index)
       {
-        assert(index < out.size());
+        assert(index < size);
 #ifndef NDEBUG
         if(first_unused_index <= index)
           first_unused_index = index+1;
@@ -82,7 +93,9 @@ namespace Dune
     //! Access output vector of evaluateJacobian()
     template <typename Traits>
     class JacobianAccess {
-      std::vector<typename Traits::JacobianType> &out;
+      typedef typename std::vector<typename Traits::JacobianType>::iterator Iterator;
+      Iterator out;
+      unsigned int size;
       unsigned int row;
 #ifndef NDEBUG
       unsigned int first_unused_index;
@@ -91,19 +104,26 @@ namespace Dune
     public:
       JacobianAccess(std::vector<typename Traits::JacobianType> &out_,
                      unsigned int row_)
-        : out(out_), row(row_)
+        : out(out_.begin()), size(out_.size()), row(row_)
+#ifndef NDEBUG
+          , first_unused_index(0)
+#endif
+      { }
+      //! Access size_ entries starting at out_, used for batched evaluation
+      JacobianAccess(Iterator out_, unsigned int size_, unsigned int row_)
+        : out(out_), size(size_), row(row_)
 #ifndef NDEBUG
           , first_unused_index(0)
 #endif
       { }
 #ifndef NDEBUG
       ~JacobianAccess() {
-        assert(first_unused_index == out.size());
+        assert(first_unused_index == size);
       }
 #endif
       typename Traits::RangeFieldType &operator[](unsigned int index)
       {
-        assert(index < out.size());
+        assert(index < size);
 #ifndef NDEBUG
         if(first_unused_index <= index)
           first_unused_index = index+1;
@@ -112,6 +132,51 @@ namespace Dune
       }
     };
 
+    //! Access the first size_ entries of the output of evaluateHessian(), fills both symmetric entries
+    template <typename Traits, class Out>
+    class HessianAccess {
+      Out &out;
+      unsigned int size;
+      unsigned int row, col;
+#ifndef NDEBUG
+      unsigned int first_unused_index;
+#endif
+
+    public:
+      HessianAccess(Out &out_, unsigned int size_,
+                    unsigned int row_, unsigned int col_)
+        : out(out_), size(size_), row(row_), col(col_)
+#ifndef NDEBUG
+          , first_unused_index(0)
+#endif
+      { }
+#ifndef NDEBUG
+      ~HessianAccess() {
+        assert(first_unused_index == size);
+      }
+#endif
+      //! Proxy assigning to the entries (row,col) and (col,row)
+      struct Entry {
+        typename Traits::HessianType::value_type &hessian;
+        unsigned int row, col;
+        Entry &operator=(const typename Traits::RangeFieldType &value)
+        {
+          hessian[row][col] = value;
+          hessian[col][row] = value;
+          return *this;
+        }
+      };
+      Entry operator[](unsigned int index)
+      {
+        assert(index < size);
+#ifndef NDEBUG
+        if(first_unused_index <= index)
+          first_unused_index = index+1;
+#endif
+        return Entry{out[index][0], row, col};
+      }
+    };
+
     /** Template Metaprogramm for evaluating monomial shapefunctions
      *  \internal
      *
@@ -255,6 +320,26 @@ namespace Dune
         MonomImp::Evaluate<Traits, d>::eval(in, derivatives, 1, lp, index, access);
     }
 
+    /** \brief Evaluate all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Values, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateFunctionBatch (const Points& points,
+                                std::vector<typename Traits::RangeType>& out) const
+    {
+      out.resize(points.size()*size());
+      std::array<int, d> derivatives;
+      std::fill(derivatives.begin(), derivatives.end(), 0);
+      for (std::size_t q = 0; q < points.size(); ++q)
+      {
+        int index = 0;
+        MonomImp::EvalAccess<Traits> access(out.begin()+q*size(), size());
+        for (unsigned int lp = 0; lp <= p; ++lp)
+          MonomImp::Evaluate<Traits, d>::eval(points[q], derivatives, 1, lp, index, access);
+      }
+    }
+
     /** \brief Evaluate partial derivatives of any order of all shape functions
      * \param order Order of the partial derivatives, in the classic multi-index notation
      * \param in Position where to evaluate the derivatives
@@ -293,6 +378,56 @@ namespace Dune
       }
     }
 
+    /** \brief Evaluate Jacobian of all shape functions at a set of points
+     * \param points Random access container of positions
+     * \param[out] out Jacobians, out[q*size()+i] belongs to shape function i at points[q]
+     */
+    template<class Points>
+    void evaluateJacobianBatch (const Points& points,
+                                std::vector<typename Traits::JacobianType>& out) const
+    {
+      out.resize(points.size()*size());
+      std::array<int, d> derivatives;
+      std::fill(derivatives.begin(), derivatives.end(), 0);
+      for (std::size_t q = 0; q < points.size(); ++q)
+      {
+        for (unsigned int i = 0; i < d; ++i)
+        {
+          derivatives[i] = 1;
+          int index = 0;
+          MonomImp::JacobianAccess<Traits> access(out.begin()+q*size(), size(), i);
+          for (unsigned int lp = 0; lp <= p; ++lp)
+            MonomImp::Evaluate<Traits, d>::eval(points[q], derivatives, 1, lp, index, access);
+          derivatives[i] = 0;
+        }
+      }
+    }
+
+    /** \brief Evaluate the second derivatives of all shape functions
+     * \param in Position where to evaluate the derivatives
+     * \param[out] out Hessians, see LocalBasisTraits::HessianType
+     */
+    template<class Out>
+    void evaluateHessian (const typename Traits::DomainType& in,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, size());
+      std::array<int, d> derivatives;
+      std::fill(derivatives.begin(), derivatives.end(), 0);
+      for(unsigned int i = 0; i < d; ++i)
+        for(unsigned int j = i; j < d; ++j)
+        {
+          ++derivatives[i];
+          ++derivatives[j];
+          int index = 0;
+          MonomImp::HessianAccess<Traits, Out> access(out, size(), i, j);
+          for(unsigned int lp = 0; lp <= p; ++lp)
+            MonomImp::Evaluate<Traits, d>::eval(in, derivatives, 1, lp, index, access);
+          --derivatives[i];
+          --derivatives[j];
+        }
+    }
+
     //! \brief Polynomial order of the shape functions
     unsigned int order () const
     {
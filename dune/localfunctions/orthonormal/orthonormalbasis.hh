@@ -3,10 +3,15 @@
 #ifndef DUNE_ORTHONORMALBASIS_HH
 #define DUNE_ORTHONORMALBASIS_HH
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
 
 #include <dune/geometry/topologyfactory.hh>
 
+#include <dune/localfunctions/utility/basiscoefficientcache.hh>
 #include <dune/localfunctions/utility/polynomialbasis.hh>
 #include <dune/localfunctions/orthonormal/orthonormalcompute.hh>
 
@@ -22,7 +27,7 @@ namespace Dune
   {
     typedef Dune::MonomialBasisProvider< dim, SF > MonomialBasisProviderType;
     typedef typename MonomialBasisProviderType::Object MonomialBasisType;
-    typedef SparseCoeffMatrix< SF, 1 > CoefficientMatrix;
+    typedef AdaptiveCoeffMatrix< SF, 1 > CoefficientMatrix;
     typedef StandardEvaluator< MonomialBasisType > Evaluator;
     typedef PolynomialBasis< Evaluator, CoefficientMatrix > Basis;
 
@@ -44,6 +49,13 @@ namespace Dune
     typedef typename Traits::Key Key;
     typedef typename Traits::Object Object;
 
+    /** \brief revision of the coefficient computation, see BasisCoefficientCache
+     *
+     *  Revision 2 orthonormalizes by a Cholesky factorization of the Gram
+     *  matrix instead of the Gram-Schmidt procedure.
+     */
+    static const unsigned int coefficientRevision = 2;
+
     template <unsigned int dd, class FF>
     struct EvaluationBasisFactory
     {
@@ -53,7 +65,7 @@ namespace Dune
     typedef typename EvaluationBasisFactory< dimension, StorageField >::Type MonomialBasisProviderType;
     typedef typename MonomialBasisProviderType::Object MonomialBasisType;
 
-    typedef SparseCoeffMatrix< StorageField, 1 > CoefficientMatrix;
+    typedef AdaptiveCoeffMatrix< StorageField, 1 > CoefficientMatrix;
     typedef StandardEvaluator< MonomialBasisType > Evaluator;
     typedef PolynomialBasis< Evaluator, CoefficientMatrix > Basis;
 
@@ -63,15 +75,59 @@ namespace Dune
     static Object *createObject ( const unsigned int order )
     {
       const typename Traits::MonomialBasisType &monomialBasis = *Traits::MonomialBasisProviderType::template create< SimplexTopology >( order );
+      return new Basis( monomialBasis, coefficients< Topology >( order ), monomialBasis.size() );
+    }
+
+  private:
+    struct CoefficientEntry
+    {
+      std::once_flag computed;
+      CoefficientMatrix matrix;
+    };
+
+    /** \brief coefficients of the orthonormal basis of the given order
+     *
+     *  The matrix is computed once per topology, order, and field types,
+     *  on the first request, and kept until the end of the program. It may
+     *  be requested concurrently; only the lookup of the entry is
+     *  serialized, the computations for different orders run in parallel.
+     */
+    template< class Topology >
+    static const CoefficientMatrix &coefficients ( const unsigned int order )
+    {
+      static std::mutex mutex;
+      static std::map< unsigned int, std::unique_ptr< CoefficientEntry > > entries;
 
-      static typename Traits::CoefficientMatrix _coeffs;
-      if( _coeffs.size() <= monomialBasis.size() )
+      CoefficientEntry *entry;
       {
-        ONBCompute::ONBMatrix< Topology, ComputeField > matrix( order );
-        _coeffs.fill( matrix );
+        std::lock_guard< std::mutex > guard( mutex );
+        std::unique_ptr< CoefficientEntry > &slot = entries[ order ];
+        if( !slot )
+          slot.reset( new CoefficientEntry );
+        entry = slot.get();
       }
+      std::call_once( entry->computed, [ entry, order ] () { compute< Topology >( order, entry->matrix ); } );
+      return entry->matrix;
+    }
 
-      return new Basis( monomialBasis, _coeffs, monomialBasis.size() );
+    template< class Topology >
+    static void compute ( const unsigned int order, CoefficientMatrix &coeffs )
+    {
+      const std::string cacheKey
+        = BasisCoefficientCache::key< OrthonormalBasisFactory, Key, StorageField, ComputeField >( Topology::id, dimension, order );
+      StoredBasisMatrix< StorageField > storedMatrix;
+      if( BasisCoefficientCache::load( cacheKey, storedMatrix ) )
+        coeffs.fill( storedMatrix );
+      else
+      {
+        ONBCompute::ONBMatrix< Topology, ComputeField > matrix( order );
+        if( BasisCoefficientCache::enabled() && !cacheKey.empty() )
+        {
+          storedMatrix = StoredBasisMatrix< StorageField >( matrix );
+          BasisCoefficientCache::store( cacheKey, storedMatrix );
+        }
+        coeffs.fill( matrix );
+      }
     }
   };
 
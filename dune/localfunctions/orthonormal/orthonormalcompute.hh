@@ -9,6 +9,7 @@
 #include <iomanip>
 #include <map>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/fmatrix.hh>
 
 #include <dune/geometry/type.hh>
@@ -117,11 +118,12 @@ namespace ONBCompute
       S.resize( size, size );
       d.resize( size );
 
-      // setup matrix for bilinear form x^T S y: S_ij = int_A x^(i+j)
+      // setup matrix for bilinear form x^T S y: S_ij = int_A x^(i+j),
+      // only the lower triangle is used
       scalar_t p, q;
       for( std::size_t i = 0; i < size; ++i )
       {
-        for( std::size_t j = 0; j < size; ++j )
+        for( std::size_t j = 0; j <= i; ++j )
         {
           Integral< Topology >::compute( y[ i ][ 0 ] * y[ j ][ 0 ], p, q );
           S( i, j ) = p;
@@ -130,7 +132,7 @@ namespace ONBCompute
       }
 
       // orthonormalize
-      gramSchmidt();
+      orthonormalize();
     }
 
     template< class Vector >
@@ -143,52 +145,44 @@ namespace ONBCompute
     }
 
   private:
-    void sprod ( int col1, int col2, scalar_t &ret )
+    // The Gram-Schmidt procedure applied to the monomials with the
+    // identity as initial matrix yields the upper triangular matrix C
+    // with positive diagonal and C^T S C = I. With the Cholesky
+    // factorization S = L L^T this is C = L^{-T}, which is computed in
+    // O(n^3) operations instead of the O(n^4) of the explicit procedure.
+    void orthonormalize ()
     {
-      ret = 0;
-      for( int k = 0; k <= col1; ++k )
-      {
-        for( int l = 0; l <=col2; ++l )
-          ret += Base::operator()( l, col2 ) * S( l, k ) * Base::operator()( k, col1 );
-      }
-    }
-
-    void vmul ( std::size_t col, std::size_t rowEnd, const scalar_t &s )
-    {
-      for( std::size_t i = 0; i <= rowEnd; ++i )
-        Base::operator()( i, col ) *= s;
-    }
+      const std::size_t N = Base::rows();
 
-    void vsub ( std::size_t coldest, std::size_t colsrc, std::size_t rowEnd, const scalar_t &s )
-    {
-      for( std::size_t i = 0; i <= rowEnd; ++i )
-        Base::operator()( i, coldest ) -= s * Base::operator()( i, colsrc );
-    }
+      Dune::LFECholesky< scalar_t > cholesky;
+      if( !cholesky.factorize( S ) )
+        DUNE_THROW( Dune::MathError, "Gram matrix of the monomials is not positive definite" );
 
-    void gramSchmidt ()
-    {
-      // setup identity
-      const std::size_t N = Base::rows();
+      // X = L^{-1} by forward substitution with whole rows of X
+      mat_t X;
+      X.resize( N, N );
       for( std::size_t i = 0; i < N; ++i )
       {
+        scalar_t *xi = X.rowPtr( i );
         for( std::size_t j = 0; j < N; ++j )
-          Base::operator()( i, j ) = scalar_t( i == j ? 1 : 0 );
-      }
-
-      // perform Gram-Schmidt procedure
-      scalar_t s;
-      sprod( 0, 0, s );
-      vmul( 0, 0, scalar_t( 1 ) / sqrt( s ) );
-      for( std::size_t i = 1; i < N; ++i )
-      {
+          xi[ j ] = scalar_t( 0 );
+        xi[ i ] = scalar_t( 1 );
         for( std::size_t k = 0; k < i; ++k )
         {
-          sprod( i, k, s );
-          vsub( i, k, i, s );
+          const scalar_t lik = cholesky.lower( i, k );
+          const scalar_t *xk = X.rowPtr( k );
+          for( std::size_t j = 0; j <= k; ++j )
+            xi[ j ] -= lik * xk[ j ];
         }
-        sprod( i, i, s );
-        vmul( i, i, scalar_t( 1 ) / sqrt( s ) );
+        const scalar_t hr = scalar_t( 1 ) / cholesky.lower( i, i );
+        for( std::size_t j = 0; j <= i; ++j )
+          xi[ j ] *= hr;
       }
+
+      // C = X^T
+      for( std::size_t i = 0; i < N; ++i )
+        for( std::size_t j = 0; j < N; ++j )
+          Base::operator()( i, j ) = X( j, i );
     }
 
     vec_t d;
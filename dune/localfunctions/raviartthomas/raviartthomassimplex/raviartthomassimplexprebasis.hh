@@ -22,7 +22,7 @@ namespace Dune
     typedef MonomialBasisProvider<dim,Field> MBasisFactory;
     typedef typename MBasisFactory::Object MBasis;
     typedef StandardEvaluator<MBasis> EvalMBasis;
-    typedef PolynomialBasisWithMatrix<EvalMBasis,SparseCoeffMatrix<Field,dim> > Basis;
+    typedef PolynomialBasisWithMatrix<EvalMBasis,AdaptiveCoeffMatrix<Field,dim> > Basis;
 
     typedef const Basis Object;
     typedef unsigned int Key;
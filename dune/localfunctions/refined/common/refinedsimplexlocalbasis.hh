@@ -7,6 +7,8 @@
     \brief Contains a base class for LocalBasis classes based on uniform refinement
  */
 
+#include <array>
+
 #include <dune/common/fvector.hh>
 #include <dune/common/exceptions.hh>
 #include <dune/localfunctions/common/localbasis.hh>
@@ -58,6 +60,22 @@ namespace Dune
       DUNE_THROW(InvalidStateException, "no subelement defined");
     }
 
+    /** \brief Get the subelement containing a given point as a set of masks
+     *
+     * Same as getSubElement(), but without branching on the coordinates:
+     * entry i is the result of the comparisons that identify subelement i.
+     * For vectorized field types D this is a mask with one entry per lane,
+     * which can be used for lane-wise selection instead of a branch.
+     *
+     * \param[in] global Coordinates in the reference element
+     */
+    static auto subElementMasks(const FieldVector<D,1>& global)
+      -> std::array<decltype(global[0] <= 0.5),2>
+    {
+      const auto left = (global[0] <= 0.5);
+      return {{ left, !left }};
+    }
+
     /** \brief Get local coordinates in the subelement
 
        \param[in] global Coordinates in the reference element
@@ -126,6 +144,22 @@ namespace Dune
       return 3;
     }
 
+    /** \brief Get the subtriangle containing a given point as a set of masks
+     *
+     * Same as getSubElement(), but without branching on the coordinates;
+     * see RefinedSimplexLocalBasis<D,1>::subElementMasks().
+     *
+     * \param[in] global Coordinates in the reference triangle
+     */
+    static auto subElementMasks(const FieldVector<D,2>& global)
+      -> std::array<decltype(global[0] <= 0.5),4>
+    {
+      const auto in0 = (global[0] + global[1] <= 0.5);
+      const auto in1 = !in0 && (global[0] >= 0.5);
+      const auto in2 = !in0 && !in1 && (global[1] >= 0.5);
+      return {{ in0, in1, in2, !in0 && !in1 && !in2 }};
+    }
+
     /** \brief Get local coordinates in the subtriangle
 
        \param[in] global Coordinates in the reference triangle
@@ -232,6 +266,33 @@ namespace Dune
       DUNE_THROW(InvalidStateException, "no subelement defined");
 
     }
+
+    /** \brief Get the subsimplex containing a given point as a set of masks
+     *
+     * Same as getSubElement(), but without branching on the coordinates;
+     * see RefinedSimplexLocalBasis<D,1>::subElementMasks().
+     *
+     * \param[in] global Coordinates in the reference simplex
+     */
+    static auto subElementMasks(const FieldVector<D,3>& global)
+      -> std::array<decltype(global[0] <= 0.5),8>
+    {
+      const auto corner0 = (global[0] + global[1] + global[2] <= 0.5);
+      const auto corner1 = !corner0 && (global[0] >= 0.5);
+      const auto corner2 = !corner0 && !corner1 && (global[1] >= 0.5);
+      const auto corner3 = !corner0 && !corner1 && !corner2 && (global[2] >= 0.5);
+      const auto octahedron = !corner0 && !corner1 && !corner2 && !corner3;
+
+      // the octahedron is split along the planes x+y=1/2 and y+z=1/2
+      const auto lower01 = (global[0] + global[1] <= 0.5);
+      const auto lower12 = (global[1] + global[2] <= 0.5);
+      const auto in4 = octahedron && lower01 && lower12;
+      const auto in5 = octahedron && !in4 && lower12;
+      const auto in6 = octahedron && !in4 && !in5 && lower01;
+      return {{ corner0, corner1, corner2, corner3,
+                in4, in5, in6, octahedron && !in4 && !in5 && !in6 }};
+    }
+
     /** \brief Get local coordinates in the subsimplex
 
        \param[in] global Coordinates in the reference simplex
@@ -7,6 +7,7 @@
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/common/simd.hh>
 
 #include <dune/localfunctions/common/localbasis.hh>
 #include <dune/localfunctions/refined/common/refinedsimplexlocalbasis.hh>
@@ -48,14 +49,19 @@ namespace Dune
       return N;
     }
 
-    //! \brief Evaluate all shape functions
+    /** \brief Evaluate all shape functions
+     *
+     * The subelement is selected by masks instead of branches, so that
+     * vectorized field types can be used for D and R.
+     */
     inline void evaluateFunction (const typename Traits::DomainType& in,
                                   std::vector<typename Traits::RangeType>& out) const
     {
-      int subElement = this->getSubElement(in);
+      using Dune::cond;
+      const auto masks = this->subElementMasks(in);
       out.resize(N);
       for(int i=0; i<N; ++i)
-        out[i] = (i==subElement) ? 1 : 0;
+        out[i] = cond(masks[i], R(1), R(0));
     }
 
     inline void
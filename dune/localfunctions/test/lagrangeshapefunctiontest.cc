@@ -164,6 +164,14 @@ int main (int argc, char *argv[]) try
   testPk(pk32d);
   Pk2DLocalFiniteElement<double,double,4> pk42d;
   testPk(pk42d);
+  Pk2DLocalFiniteElement<double,double,5> pk52d;
+  testPk(pk52d);
+  Pk2DLocalFiniteElement<double,double,6> pk62d;
+  testPk(pk62d);
+  Pk2DLocalFiniteElement<double,double,7> pk72d;
+  testPk(pk72d);
+  Pk2DLocalFiniteElement<double,double,8> pk82d;
+  testPk(pk82d);
 
   Pk3DLocalFiniteElement<double,double,1> pk13d;
   testPk(pk13d);
@@ -173,6 +181,14 @@ int main (int argc, char *argv[]) try
   testPk(pk33d);
   Pk3DLocalFiniteElement<double,double,4> pk43d;
   testPk(pk43d);
+  Pk3DLocalFiniteElement<double,double,5> pk53d;
+  testPk(pk53d);
+  Pk3DLocalFiniteElement<double,double,6> pk63d;
+  testPk(pk63d);
+  Pk3DLocalFiniteElement<double,double,7> pk73d;
+  testPk(pk73d);
+  Pk3DLocalFiniteElement<double,double,8> pk83d;
+  testPk(pk83d);
 
   return success ? 0 : 1;
 }
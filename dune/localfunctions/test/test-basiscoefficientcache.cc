@@ -0,0 +1,185 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/orthonormal.hh>
+#include <dune/localfunctions/utility/basiscoefficientcache.hh>
+
+/** \file
+ * \brief Test the on-disk cache for the coefficients of generic bases
+ *
+ * Elements constructed with the cache, from a stored or from a damaged
+ * cache file, have to agree with elements computed without the cache.
+ * Entries of a different revision of the coefficient computation must
+ * not be found.
+ */
+
+double TOL = 1e-12;
+
+// values of all shape functions at a few points
+template<class FE>
+std::vector<double> values(const FE& fe)
+{
+  typedef typename FE::Traits::LocalBasisType::Traits::DomainType DomainType;
+  typedef typename FE::Traits::LocalBasisType::Traits::RangeType RangeType;
+
+  std::vector<double> result;
+  std::vector<RangeType> y;
+  for (int i=1; i<=3; ++i)
+  {
+    DomainType x(0.1*i);
+    fe.localBasis().evaluateFunction(x, y);
+    for (const auto& v : y)
+      result.push_back(v[0]);
+  }
+  return result;
+}
+
+template<class FE>
+std::string cacheFile(const Dune::GeometryType& gt, const typename FE::Key& key)
+{
+  typedef typename FE::BasisFactory BasisFactory;
+  return Dune::BasisCoefficientCache::fileName(
+    Dune::BasisCoefficientCache::key<typename BasisFactory::Factory, typename FE::Key,
+                                     typename BasisFactory::StorageField,
+                                     typename BasisFactory::ComputeField>(gt.id(), FE::dimDomain, key));
+}
+
+bool exists(const std::string& fileName)
+{
+  return bool(std::ifstream(fileName));
+}
+
+bool compare(const std::vector<double>& a, const std::vector<double>& b, const std::string& what)
+{
+  bool equal = (a.size() == b.size());
+  for (std::size_t i=0; equal and i<a.size(); ++i)
+    equal = (std::abs(a[i] - b[i]) < TOL);
+  if (not equal)
+    std::cout << "Basis " << what << " differs from the basis computed without cache" << std::endl;
+  return equal;
+}
+
+template<class FE>
+bool testCache(const Dune::GeometryType& gt, unsigned int order, const std::string& name,
+               bool reloadable)
+{
+  bool success = true;
+
+  Dune::BasisCoefficientCache::setDirectory(".");
+  const std::string fileName = cacheFile<FE>(gt, order);
+  std::remove(fileName.c_str());
+  const std::vector<double> stored = values(FE(gt, order));
+
+  Dune::BasisCoefficientCache::setDirectory("");
+  const std::vector<double> reference = values(FE(gt, order));
+  Dune::BasisCoefficientCache::setDirectory(".");
+
+  success = compare(stored, reference, name + " stored in the cache") and success;
+  if (not exists(fileName))
+  {
+    std::cout << "Coefficients of " << name << " were not stored in " << fileName << std::endl;
+    success = false;
+  }
+
+  if (reloadable)
+  {
+    success = compare(values(FE(gt, order)), reference, name + " loaded from the cache") and success;
+
+    // damage the file, it has to be ignored and rewritten
+    {
+      std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+      out << "DUNELFBC garbage";
+    }
+    success = compare(values(FE(gt, order)), reference, name + " with a damaged cache file") and success;
+
+    Dune::StoredBasisMatrix<double> matrix;
+    typedef typename FE::BasisFactory BasisFactory;
+    const std::string key = Dune::BasisCoefficientCache::key<typename BasisFactory::Factory, typename FE::Key,
+                                                             double, double>(gt.id(), FE::dimDomain, order);
+    if (not Dune::BasisCoefficientCache::load(key, matrix))
+    {
+      std::cout << "Damaged cache file for " << name << " was not replaced" << std::endl;
+      success = false;
+    }
+  }
+
+  std::remove(fileName.c_str());
+  Dune::BasisCoefficientCache::setDirectory("");
+  return success;
+}
+
+// stand-in for a basis factory whose coefficient computation changed
+template<unsigned int revision>
+struct RevisedFactory
+{
+  static const unsigned int coefficientRevision = revision;
+};
+
+bool testRevision()
+{
+  typedef Dune::BasisCoefficientCache Cache;
+  const std::string oldKey = Cache::key<RevisedFactory<1>, unsigned int, double, double>(0, 2, 3);
+  const std::string newKey = Cache::key<RevisedFactory<2>, unsigned int, double, double>(0, 2, 3);
+  if (oldKey == newKey)
+  {
+    std::cout << "Cache keys do not depend on the coefficient revision" << std::endl;
+    return false;
+  }
+
+  Cache::setDirectory(".");
+  Dune::StoredBasisMatrix<double> matrix;
+  matrix.resize(2, 2);
+  Cache::store(oldKey, matrix);
+  bool success = true;
+  if (Cache::load(newKey, matrix))
+  {
+    std::cout << "Cache entry of an old revision was loaded" << std::endl;
+    success = false;
+  }
+  std::remove(Cache::fileName(oldKey).c_str());
+  Cache::setDirectory("");
+  return success;
+}
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,2,double,double> Lagrange2D;
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,3,double,double> Lagrange3D;
+  // the orthonormal basis computes its coefficients once and keeps them in memory
+  typedef Dune::OrthonormalLocalFiniteElement<3,double,double> Orthonormal3D;
+
+  Dune::GeometryType triangle, hexahedron, tetrahedron;
+  triangle.makeTriangle();
+  hexahedron.makeHexahedron();
+  tetrahedron.makeTetrahedron();
+
+  success = testCache<Lagrange2D>(triangle, 3, "Lagrange P3", true) and success;
+  success = testCache<Lagrange3D>(hexahedron, 2, "Lagrange Q2", true) and success;
+  success = testCache<Orthonormal3D>(tetrahedron, 3, "orthonormal", false) and success;
+  success = testRevision() and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
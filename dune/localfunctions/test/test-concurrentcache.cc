@@ -0,0 +1,200 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/dualmortarbasis/dualpq1factory.hh>
+#include <dune/localfunctions/lagrange/pqkfactory.hh>
+#include <dune/localfunctions/orthonormal.hh>
+
+/** \file
+ * \brief Stress test for the thread-safe local finite element caches
+ *
+ * Many threads request elements for all geometry types concurrently from
+ * a single cache. All threads have to obtain the same objects, and these
+ * have to agree with the elements of the sequential cache.
+ *
+ * Further, many threads construct orthonormal elements of several orders
+ * concurrently, which share the coefficients computed on first use.
+ */
+
+// sum of all shape function values at a fixed point
+template<class FE>
+double checksum(const FE& fe)
+{
+  typedef typename FE::Traits::LocalBasisType::Traits::DomainType DomainType;
+  typedef typename FE::Traits::LocalBasisType::Traits::RangeType RangeType;
+
+  DomainType x(0.2);
+  std::vector<RangeType> values;
+  fe.localBasis().evaluateFunction(x, values);
+
+  double sum = 0;
+  for (std::size_t i=0; i<values.size(); ++i)
+    sum += (i+1)*values[i][0];
+  return sum;
+}
+
+template<class Cache, class SequentialCache>
+bool testConcurrentCache(const std::vector<Dune::GeometryType>& types, const std::string& name)
+{
+  typedef typename Cache::FiniteElementType FE;
+
+  const int numThreads = 16;
+  const int iterations = 200;
+
+  Cache cache;
+  SequentialCache sequentialCache;
+
+  std::vector<double> reference;
+  for (const auto& gt : types)
+    reference.push_back(checksum(sequentialCache.get(gt)));
+
+  std::vector<std::vector<const FE*> > elements(numThreads, std::vector<const FE*>(types.size(), nullptr));
+  std::vector<int> failures(numThreads, 0);
+
+  std::vector<std::thread> threads;
+  for (int t=0; t<numThreads; ++t)
+    threads.emplace_back([&, t]() {
+      for (int n=0; n<iterations; ++n)
+        for (std::size_t g=0; g<types.size(); ++g)
+        {
+          // let the threads start at different geometry types
+          const std::size_t j = (g+t) % types.size();
+          const FE& fe = cache.get(types[j]);
+
+          if (elements[t][j] == nullptr)
+            elements[t][j] = &fe;
+          else if (elements[t][j] != &fe)
+            ++failures[t];
+
+          if (std::abs(checksum(fe) - reference[j]) > 1e-12)
+            ++failures[t];
+        }
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  bool success = true;
+
+  // topology ids differing in the lowest bit describe the same geometry type
+  for (const auto& gt : types)
+  {
+    const Dune::GeometryType equivalent(gt.id() ^ 1u, gt.dim());
+    if (&cache.get(equivalent) != &cache.get(gt))
+    {
+      std::cout << "Equivalent geometry types " << gt << " get different elements from "
+                << name << std::endl;
+      success = false;
+    }
+  }
+
+  for (int t=0; t<numThreads; ++t)
+  {
+    if (failures[t] > 0)
+    {
+      std::cout << "Thread " << t << " observed " << failures[t] << " inconsistent lookups in "
+                << name << std::endl;
+      success = false;
+    }
+
+    for (std::size_t g=0; g<types.size(); ++g)
+      if (elements[t][g] != elements[0][g])
+      {
+        std::cout << "Threads obtained different elements for " << types[g]
+                  << " from " << name << std::endl;
+        success = false;
+      }
+  }
+
+  return success;
+}
+
+template<class FE>
+bool testConcurrentOrthonormal(const Dune::GeometryType& gt, unsigned int maxOrder, const std::string& name)
+{
+  const int numThreads = 16;
+
+  std::vector<std::vector<double> > checksums(numThreads, std::vector<double>(maxOrder+1, 0.0));
+  std::vector<std::thread> threads;
+  for (int t=0; t<numThreads; ++t)
+    threads.emplace_back([&, t]() {
+      // let the threads start at different orders
+      for (unsigned int o=0; o<=maxOrder; ++o)
+      {
+        const unsigned int order = (o+t) % (maxOrder+1);
+        checksums[t][order] = checksum(FE(gt, order));
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  bool success = true;
+  for (unsigned int order=0; order<=maxOrder; ++order)
+  {
+    const double reference = checksum(FE(gt, order));
+    for (int t=0; t<numThreads; ++t)
+      if (std::abs(checksums[t][order] - reference) > 1e-12)
+      {
+        std::cout << "Thread " << t << " constructed a wrong " << name
+                  << " of order " << order << std::endl;
+        success = false;
+      }
+  }
+  return success;
+}
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  Dune::GeometryType gt;
+  std::vector<Dune::GeometryType> types2d, types3d;
+  gt.makeTriangle();
+  types2d.push_back(gt);
+  gt.makeQuadrilateral();
+  types2d.push_back(gt);
+  gt.makeTetrahedron();
+  types3d.push_back(gt);
+  gt.makeHexahedron();
+  types3d.push_back(gt);
+  gt.makePrism();
+  types3d.push_back(gt);
+  gt.makePyramid();
+  types3d.push_back(gt);
+
+  success = testConcurrentCache<Dune::ConcurrentPQkLocalFiniteElementCache<double,double,2,2>,
+                                Dune::PQkLocalFiniteElementCache<double,double,2,2> >(types2d, "PQk cache 2d") and success;
+  success = testConcurrentCache<Dune::ConcurrentPQkLocalFiniteElementCache<double,double,3,1>,
+                                Dune::PQkLocalFiniteElementCache<double,double,3,1> >(types3d, "PQk cache 3d") and success;
+  success = testConcurrentCache<Dune::ConcurrentDualPQ1LocalFiniteElementCache<double,double,2>,
+                                Dune::DualPQ1LocalFiniteElementCache<double,double,2> >(types2d, "dual PQ1 cache 2d") and success;
+  types3d.resize(2);
+  success = testConcurrentCache<Dune::ConcurrentDualPQ1LocalFiniteElementCache<double,double,3,true>,
+                                Dune::DualPQ1LocalFiniteElementCache<double,double,3,true> >(types3d, "dual PQ1 cache 3d") and success;
+
+  gt.makeTriangle();
+  success = testConcurrentOrthonormal<Dune::OrthonormalLocalFiniteElement<2,double,double> >(gt, 6, "orthonormal element 2d") and success;
+  gt.makeTetrahedron();
+  success = testConcurrentOrthonormal<Dune::OrthonormalLocalFiniteElement<3,double,double> >(gt, 4, "orthonormal element 3d") and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
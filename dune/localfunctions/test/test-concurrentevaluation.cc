@@ -0,0 +1,174 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange.hh>
+#include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/orthonormal.hh>
+#include <dune/localfunctions/utility/localfiniteelement.hh>
+
+/** \file
+ * \brief Concurrent evaluation of a single generic local finite element
+ *
+ * Many threads evaluate the same element object at different points and
+ * interpolate with it. The results have to agree with a sequential
+ * evaluation. Run with the thread sanitizer to detect data races in the
+ * const evaluation and interpolation methods.
+ *
+ * Every other thread works on its own copy of the element, which has to
+ * share the basis, coefficients, and interpolation with the original.
+ */
+
+// a smooth function to interpolate
+template<class Domain, class Range>
+struct TestFunction
+{
+  typedef Domain DomainType;
+  typedef Range RangeType;
+
+  void evaluate(const DomainType& x, RangeType& y) const
+  {
+    for (std::size_t r=0; r<y.size(); ++r)
+    {
+      y[r] = r+1;
+      for (std::size_t d=0; d<x.size(); ++d)
+        y[r] += std::sin((r+d+1)*x[d]);
+    }
+  }
+};
+
+// values and Jacobians of all shape functions at all points, and the
+// interpolation of a function
+template<class FE, class Points>
+std::vector<double> evaluate(const FE& fe, const Points& points)
+{
+  typedef typename FE::Traits::LocalBasisType::Traits LBTraits;
+
+  std::vector<double> result;
+  std::vector<typename LBTraits::RangeType> values;
+  std::vector<typename LBTraits::JacobianType> jacobians;
+  for (const auto& x : points)
+  {
+    fe.localBasis().evaluateFunction(x, values);
+    fe.localBasis().evaluateJacobian(x, jacobians);
+    for (std::size_t i=0; i<values.size(); ++i)
+    {
+      for (int r=0; r<LBTraits::dimRange; ++r)
+      {
+        result.push_back(values[i][r]);
+        for (int d=0; d<LBTraits::dimDomain; ++d)
+          result.push_back(jacobians[i][r][d]);
+      }
+    }
+  }
+
+  fe.localBasis().evaluateFunctionBatch(points, values);
+  for (const auto& v : values)
+    for (int r=0; r<LBTraits::dimRange; ++r)
+      result.push_back(v[r]);
+
+  std::vector<double> coefficients;
+  fe.localInterpolation().interpolate(TestFunction<typename LBTraits::DomainType, typename LBTraits::RangeType>(),
+                                      coefficients);
+  result.insert(result.end(), coefficients.begin(), coefficients.end());
+  return result;
+}
+
+template<class FE>
+bool testConcurrentEvaluation(const FE& fe, const std::string& name)
+{
+  typedef typename FE::Traits::LocalBasisType::Traits::DomainType DomainType;
+  const int dim = DomainType::dimension;
+
+  const int numThreads = 16;
+  const int iterations = 50;
+  const int numPoints = 8;
+
+  // each thread evaluates at its own set of points inside the reference element
+  std::vector<std::vector<DomainType> > points(numThreads);
+  std::vector<std::vector<double> > reference(numThreads);
+  for (int t=0; t<numThreads; ++t)
+  {
+    for (int q=0; q<numPoints; ++q)
+    {
+      DomainType x;
+      for (int d=0; d<dim; ++d)
+        x[d] = ((t+3*q+5*d) % 7 + 0.5) / (7.0*dim);
+      points[t].push_back(x);
+    }
+    reference[t] = evaluate(fe, points[t]);
+  }
+
+  std::vector<int> failures(numThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t=0; t<numThreads; ++t)
+    threads.emplace_back([&, t]() {
+      const FE copy(fe);
+      if (&copy.localBasis() != &fe.localBasis()
+          or &copy.localCoefficients() != &fe.localCoefficients()
+          or &copy.localInterpolation() != &fe.localInterpolation())
+        ++failures[t];
+      const FE& element = (t % 2 == 0) ? fe : copy;
+      for (int n=0; n<iterations; ++n)
+      {
+        const std::vector<double> result = evaluate(element, points[t]);
+        bool equal = (result.size() == reference[t].size());
+        for (std::size_t i=0; equal and i<result.size(); ++i)
+          equal = (std::abs(result[i] - reference[t][i]) < 1e-12);
+        if (not equal)
+          ++failures[t];
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  const int total = std::count_if(failures.begin(), failures.end(), [](int f) { return f > 0; });
+  if (total > 0)
+    std::cout << total << " threads obtained wrong values of " << name << std::endl;
+  return total == 0;
+}
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  Dune::GeometryType triangle, tetrahedron, hexahedron;
+  triangle.makeTriangle();
+  tetrahedron.makeTetrahedron();
+  hexahedron.makeHexahedron();
+
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,2,double,double> Lagrange2D;
+  typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,3,double,double> Lagrange3D;
+
+  success = testConcurrentEvaluation(Lagrange2D(triangle, 3), "Lagrange P3 on a triangle") and success;
+  success = testConcurrentEvaluation(Lagrange3D(tetrahedron, 2), "Lagrange P2 on a tetrahedron") and success;
+  success = testConcurrentEvaluation(Lagrange3D(hexahedron, 2), "Lagrange Q2 on a hexahedron") and success;
+  success = testConcurrentEvaluation(Dune::OrthonormalLocalFiniteElement<2,double,double>(triangle, 4),
+                                     "orthonormal basis of order 4 on a triangle") and success;
+  success = testConcurrentEvaluation(Dune::OrthonormalLocalFiniteElement<3,double,double>(tetrahedron, 3),
+                                     "orthonormal basis of order 3 on a tetrahedron") and success;
+  success = testConcurrentEvaluation(Dune::L2LocalFiniteElement<Lagrange2D>(triangle, 2),
+                                     "L2 projection onto Lagrange P2 on a triangle") and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,132 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/reservedvector.hh>
+
+#include <dune/localfunctions/dualmortarbasis/dualp1/dualp1localbasis.hh>
+#include <dune/localfunctions/dualmortarbasis/dualq1.hh>
+#include <dune/localfunctions/lagrange/p0/p0localbasis.hh>
+#include <dune/localfunctions/lagrange/p1/p1localbasis.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalcoefficients.hh>
+#include <dune/localfunctions/lagrange/pk3d/pk3dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/q1/q1localbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalcoefficients.hh>
+
+/** \file
+ * \brief Evaluate local bases of fixed size into std::array and ReservedVector
+ *
+ * The size of the output containers is taken from the constexpr size()
+ * of the bases.
+ *
+ * The results have to agree with the evaluation into std::vector.
+ */
+
+double TOL = 1e-14;
+
+template<class Values>
+bool compare(const Values& values, const std::vector<typename Values::value_type>& reference,
+             const std::string& what, const std::string& name)
+{
+  bool success = true;
+  for (std::size_t i=0; i<reference.size(); ++i)
+  {
+    auto difference = values[i];
+    difference -= reference[i];
+    if (difference.infinity_norm() > TOL)
+    {
+      std::cout << what << " of shape function " << i << " of " << name
+                << " differs from the evaluation into std::vector" << std::endl;
+      success = false;
+    }
+  }
+  return success;
+}
+
+template<class LB>
+bool testFixedSizeOutput(const LB& basis, const std::string& name)
+{
+  typedef typename LB::Traits Traits;
+  typedef typename Traits::RangeType RangeType;
+  typedef typename Traits::JacobianType JacobianType;
+
+  // the number of shape functions is a compile-time constant
+  constexpr std::size_t size = LB::size();
+
+  bool success = true;
+
+  typename Traits::DomainType x;
+  for (int j=0; j<Traits::dimDomain; ++j)
+    x[j] = 0.1 + 0.2*j/Traits::dimDomain;
+
+  std::vector<RangeType> values;
+  std::vector<JacobianType> jacobians;
+  basis.evaluateFunction(x, values);
+  basis.evaluateJacobian(x, jacobians);
+
+  std::array<RangeType,size> arrayValues;
+  std::array<JacobianType,size> arrayJacobians;
+  basis.evaluateFunction(x, arrayValues);
+  basis.evaluateJacobian(x, arrayJacobians);
+  success = compare(arrayValues, values, "std::array value", name) and success;
+  success = compare(arrayJacobians, jacobians, "std::array Jacobian", name) and success;
+
+  Dune::ReservedVector<RangeType,size> reservedValues;
+  Dune::ReservedVector<JacobianType,size> reservedJacobians;
+  basis.evaluateFunction(x, reservedValues);
+  basis.evaluateJacobian(x, reservedJacobians);
+  if (reservedValues.size() != size or reservedJacobians.size() != size)
+  {
+    std::cout << "Evaluation of " << name << " does not resize ReservedVector" << std::endl;
+    success = false;
+  }
+  success = compare(reservedValues, values, "ReservedVector value", name) and success;
+  success = compare(reservedJacobians, jacobians, "ReservedVector Jacobian", name) and success;
+
+  return success;
+}
+
+// local keys and the number of coefficients are known at compile time
+constexpr Dune::LocalKey key(1, 2, 0);
+static_assert(key.subEntity() == 1 and key.codim() == 2 and key.index() == 0,
+              "LocalKey cannot be evaluated at compile time");
+static_assert(Dune::Pk2DLocalCoefficients<3>::size() == 10,
+              "Pk2DLocalCoefficients::size() cannot be evaluated at compile time");
+static_assert(Dune::QkLocalCoefficients<2,3>::size() == 27,
+              "QkLocalCoefficients::size() cannot be evaluated at compile time");
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  success = testFixedSizeOutput(Dune::P0LocalBasis<double,double,2>(), "P0") and success;
+  success = testFixedSizeOutput(Dune::P1LocalBasis<double,double,3>(), "P1") and success;
+  success = testFixedSizeOutput(Dune::Q1LocalBasis<double,double,3>(), "Q1") and success;
+  success = testFixedSizeOutput(Dune::Pk2DLocalBasis<double,double,3>(), "Pk2D") and success;
+  success = testFixedSizeOutput(Dune::Pk3DLocalBasis<double,double,2>(), "Pk3D") and success;
+  success = testFixedSizeOutput(Dune::Pk3DLocalBasis<double,double,0>(), "Pk3D<0>") and success;
+  success = testFixedSizeOutput(Dune::QkLocalBasis<double,double,2,3>(), "Qk") and success;
+  success = testFixedSizeOutput(Dune::DualP1LocalBasis<double,double,2>(), "DualP1") and success;
+
+  Dune::DualQ1LocalFiniteElement<double,double,2> dualQ1;
+  success = testFixedSizeOutput(dualQ1.localBasis(), "DualQ1") and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,184 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/typeutilities.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/lagrange/p1/p1localbasis.hh>
+#include <dune/localfunctions/lagrange/pk1d/pk1dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk3d/pk3dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/monomial/monomiallocalbasis.hh>
+#include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+
+/** \file
+ * \brief Test the evaluation of the Hessians of local bases
+ *
+ * The Hessians returned by evaluateHessian are compared to finite
+ * differences of the Jacobians. For bases implementing partial() for
+ * derivatives of order two they also have to agree with the Hessians
+ * assembled from partial(). Bases implementing evaluateHessian have to
+ * give the same Hessians in a std::array.
+ */
+
+// stepsize for numerical differentiation
+static const double delta = 1e-5;
+
+template<class LB>
+bool testHessian(const LB& basis, const std::string& name, bool comparePartials)
+{
+  typedef typename LB::Traits Traits;
+  const int dim = Traits::dimDomain;
+
+  typename Traits::DomainType x;
+  for (int i=0; i<dim; ++i)
+    x[i] = 0.1 + 0.15*i;
+
+  std::vector<typename Traits::HessianType> hessians, partialHessians;
+  Dune::evaluateHessian(basis, x, hessians);
+  if (comparePartials)
+    Dune::Impl::evaluateHessian(basis, x, partialHessians, Dune::PriorityTag<0>());
+
+  bool success = true;
+  if (hessians.size() != basis.size())
+  {
+    std::cout << "Number of Hessians of " << name << " is " << hessians.size()
+              << " instead of " << basis.size() << std::endl;
+    return false;
+  }
+
+  for (int b=0; b<dim; ++b)
+  {
+    typename Traits::DomainType up = x, down = x;
+    up[b] += delta;
+    down[b] -= delta;
+    std::vector<typename Traits::JacobianType> upJacobians, downJacobians;
+    basis.evaluateJacobian(up, upJacobians);
+    basis.evaluateJacobian(down, downJacobians);
+
+    for (std::size_t i=0; i<basis.size(); ++i)
+      for (int m=0; m<Traits::dimRange; ++m)
+        for (int a=0; a<dim; ++a)
+        {
+          const double fd = (upJacobians[i][m][a] - downJacobians[i][m][a]) / (2*delta);
+          const double h = hessians[i][m][a][b];
+          if (std::abs(h - fd) > 1e-5*(1 + std::abs(fd)))
+          {
+            std::cout << "Hessian entry (" << a << "," << b << ") of shape function " << i
+                      << " of " << name << " is " << h << " instead of " << fd << std::endl;
+            success = false;
+          }
+          if (comparePartials and std::abs(h - partialHessians[i][m][a][b]) > 1e-10*(1 + std::abs(h)))
+          {
+            std::cout << "Hessian entry (" << a << "," << b << ") of shape function " << i
+                      << " of " << name << " is " << h << ", but partial() gives "
+                      << partialHessians[i][m][a][b] << std::endl;
+            success = false;
+          }
+        }
+  }
+  return success;
+}
+
+// evaluateHessian into a container of fixed size n = basis.size(), by the
+// member function, the free function, and the fallback to partial()
+template<std::size_t n, class LB>
+bool testFixedSizeHessian(const LB& basis, const std::string& name, bool comparePartials)
+{
+  typedef typename LB::Traits Traits;
+  typename Traits::DomainType x;
+  for (int i=0; i<Traits::dimDomain; ++i)
+    x[i] = 0.2 + 0.1*i;
+
+  std::vector<typename Traits::HessianType> hessians;
+  std::array<typename Traits::HessianType, n> arrayHessians, freeHessians, partialHessians;
+  basis.evaluateHessian(x, hessians);
+  basis.evaluateHessian(x, arrayHessians);
+  Dune::evaluateHessian(basis, x, freeHessians);
+  if (comparePartials)
+    Dune::Impl::evaluateHessian(basis, x, partialHessians, Dune::PriorityTag<0>());
+
+  bool success = (hessians.size() == n);
+  for (std::size_t i=0; success and i<n; ++i)
+    for (int m=0; m<Traits::dimRange; ++m)
+      for (int a=0; a<Traits::dimDomain; ++a)
+        for (int b=0; b<Traits::dimDomain; ++b)
+        {
+          const double h = hessians[i][m][a][b];
+          if (arrayHessians[i][m][a][b] != h or freeHessians[i][m][a][b] != h
+              or (comparePartials and std::abs(partialHessians[i][m][a][b] - h) > 1e-10*(1 + std::abs(h))))
+          {
+            std::cout << "Hessian entry (" << a << "," << b << ") of shape function " << i
+                      << " of " << name << " differs for std::array output" << std::endl;
+            success = false;
+          }
+        }
+  return success;
+}
+
+template<class Topology>
+bool testOrthonormal(unsigned int order)
+{
+  typedef Dune::OrthonormalBasisFactory<Topology::dimension,double,double> BasisFactory;
+  const typename BasisFactory::Object& basis = *BasisFactory::template create<Topology>(order);
+  bool success = testHessian(basis, "OrthonormalBasis on " + Topology::name() + " of order "
+                             + std::to_string(order), true);
+  BasisFactory::release(&basis);
+  return success;
+}
+
+int main(int argc, char** argv) try
+{
+  using Dune::Impl::Point;
+  using Dune::Impl::Prism;
+  using Dune::Impl::Pyramid;
+
+  bool success = true;
+
+  success = testHessian(Dune::P1LocalBasis<double,double,2>(), "P1<2>", true) and success;
+  success = testHessian(Dune::P1LocalBasis<double,double,3>(), "P1<3>", true) and success;
+  success = testHessian(Dune::Pk1DLocalBasis<double,double,4>(), "Pk1D<4>", true) and success;
+  success = testHessian(Dune::Pk2DLocalBasis<double,double,1>(), "Pk2D<1>", true) and success;
+  success = testHessian(Dune::Pk2DLocalBasis<double,double,5>(), "Pk2D<5>", true) and success;
+  success = testHessian(Dune::Pk3DLocalBasis<double,double,0>(), "Pk3D<0>", true) and success;
+  success = testHessian(Dune::Pk3DLocalBasis<double,double,4>(), "Pk3D<4>", true) and success;
+  success = testHessian(Dune::QkLocalBasis<double,double,1,2>(), "Qk<1,2>", false) and success;
+  success = testHessian(Dune::QkLocalBasis<double,double,3,2>(), "Qk<3,2>", false) and success;
+  success = testHessian(Dune::QkLocalBasis<double,double,2,3>(), "Qk<2,3>", false) and success;
+  success = testHessian(Dune::MonomialLocalBasis<double,double,2,3>(), "Monomial<2,3>", true) and success;
+  success = testHessian(Dune::MonomialLocalBasis<double,double,3,2>(), "Monomial<3,2>", true) and success;
+
+  success = testFixedSizeHessian<4>(Dune::P1LocalBasis<double,double,3>(), "P1<3>", true) and success;
+  success = testFixedSizeHessian<5>(Dune::Pk1DLocalBasis<double,double,4>(), "Pk1D<4>", true) and success;
+  success = testFixedSizeHessian<21>(Dune::Pk2DLocalBasis<double,double,5>(), "Pk2D<5>", true) and success;
+  success = testFixedSizeHessian<35>(Dune::Pk3DLocalBasis<double,double,4>(), "Pk3D<4>", true) and success;
+  success = testFixedSizeHessian<16>(Dune::QkLocalBasis<double,double,3,2>(), "Qk<3,2>", false) and success;
+  success = testFixedSizeHessian<10>(Dune::MonomialLocalBasis<double,double,2,3>(), "Monomial<2,3>", true) and success;
+  success = testFixedSizeHessian<10>(Dune::MonomialLocalBasis<double,double,3,2>(), "Monomial<3,2>", true) and success;
+
+  success = testOrthonormal<Pyramid<Pyramid<Point> > >(3) and success;
+  success = testOrthonormal<Prism<Prism<Point> > >(2) and success;
+  success = testOrthonormal<Pyramid<Pyramid<Pyramid<Point> > > >(3) and success;
+  success = testOrthonormal<Prism<Pyramid<Pyramid<Point> > > >(2) and success;
+  success = testOrthonormal<Pyramid<Prism<Prism<Point> > > >(2) and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
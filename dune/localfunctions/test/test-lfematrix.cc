@@ -0,0 +1,220 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/localfunctions/utility/lfematrix.hh>
+
+/** \file
+ * \brief Test the blocked LU factorization and inversion of LFEMatrix
+ *        and the Cholesky factorization LFECholesky
+ *
+ * The sizes are chosen around multiples of the block size, the matrices
+ * require pivoting and contain zero entries. The inversion on several
+ * threads has to give the same result as on a single one.
+ *
+ * The Cholesky factorization is applied to a matrix L L^T with a known
+ * factor L and has to reject matrices that are not positive definite.
+ */
+
+double TOL = 1e-10;
+
+void fill(Dune::LFEMatrix<double>& matrix, unsigned int n)
+{
+  matrix.resize(n, n);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+      matrix(i,j) = ((i+2*j) % 5 == 1) ? 0.0 : std::sin(1.0 + i*i + 3.0*j*j + 0.5*i*j);
+}
+
+bool testInvert(unsigned int n)
+{
+  Dune::LFEMatrix<double> matrix, inverse;
+  fill(matrix, n);
+  inverse = matrix;
+  if (not inverse.invert())
+  {
+    std::cout << "Matrix of size " << n << " reported as singular" << std::endl;
+    return false;
+  }
+
+  double error = 0;
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+    {
+      double s = 0;
+      for (unsigned int k=0; k<n; ++k)
+        s += matrix(i,k)*inverse(k,j);
+      error = std::max(error, std::abs(s - (i == j ? 1.0 : 0.0)));
+    }
+  if (error > TOL)
+    std::cout << "Inverse of size " << n << " has error " << error << std::endl;
+  return error <= TOL;
+}
+
+// the inverse must not depend on the number of threads
+bool testThreads(unsigned int n)
+{
+  Dune::LFEMatrix<double> serial, parallel;
+  fill(serial, n);
+  fill(parallel, n);
+
+  Dune::ConstructionThreadPool& pool = Dune::ConstructionThreadPool::instance();
+  const unsigned int numThreads = pool.numThreads();
+  pool.setNumThreads(1);
+  serial.invert();
+  pool.setNumThreads(4);
+  parallel.invert();
+  pool.setNumThreads(numThreads);
+
+  bool equal = true;
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+      equal = equal and (serial(i,j) == parallel(i,j));
+  if (not equal)
+    std::cout << "Inverse of size " << n << " depends on the number of threads" << std::endl;
+  return equal;
+}
+
+bool testSolve(unsigned int n)
+{
+  Dune::LFEMatrix<double> matrix, lu;
+  fill(matrix, n);
+  lu = matrix;
+  std::vector<unsigned int> pivot;
+  if (not lu.luDecompose(pivot))
+  {
+    std::cout << "LU factorization of size " << n << " failed" << std::endl;
+    return false;
+  }
+
+  std::vector<double> x(n);
+  for (unsigned int i=0; i<n; ++i)
+    x[i] = 1.0 + i;
+  std::vector<double> b(n, 0.0);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int k=0; k<n; ++k)
+      b[i] += matrix(i,k)*x[k];
+  lu.luSolve(pivot, b);
+
+  double error = 0;
+  for (unsigned int i=0; i<n; ++i)
+    error = std::max(error, std::abs(b[i] - x[i]) / (1.0 + i));
+  if (error > TOL)
+    std::cout << "LU solve of size " << n << " has error " << error << std::endl;
+  return error <= TOL;
+}
+
+// lower triangular factor with positive diagonal and some zero entries
+double factor(unsigned int i, unsigned int j)
+{
+  if (j > i)
+    return 0.0;
+  if (j == i)
+    return 1.0 + 0.5*i;
+  return ((i+j) % 3 == 0) ? 0.0 : std::cos(1.0 + i + 2.0*j);
+}
+
+bool testCholesky(unsigned int n)
+{
+  // only the lower triangle of L L^T is set, the upper one must not be used
+  Dune::LFEMatrix<double> matrix;
+  matrix.resize(n, n);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+    {
+      double s = 0;
+      for (unsigned int k=0; k<=std::min(i, j); ++k)
+        s += factor(i,k)*factor(j,k);
+      matrix(i,j) = (j <= i) ? s : 1e10;
+    }
+
+  Dune::LFECholesky<double> cholesky;
+  if (not cholesky.factorize(matrix))
+  {
+    std::cout << "Cholesky factorization of size " << n << " failed" << std::endl;
+    return false;
+  }
+
+  double error = 0;
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int j=0; j<n; ++j)
+      error = std::max(error, std::abs(cholesky.lower(i,j) - factor(i,j)));
+
+  std::vector<double> x(n);
+  for (unsigned int i=0; i<n; ++i)
+    x[i] = 1.0 + i;
+  std::vector<double> b(n, 0.0);
+  for (unsigned int i=0; i<n; ++i)
+    for (unsigned int k=0; k<n; ++k)
+      b[i] += matrix(std::max(i,k), std::min(i,k))*x[k];
+  cholesky.solve(b);
+  for (unsigned int i=0; i<n; ++i)
+    error = std::max(error, std::abs(b[i] - x[i]) / (1.0 + i));
+
+  if (error > TOL)
+    std::cout << "Cholesky factorization of size " << n << " has error " << error << std::endl;
+  return error <= TOL;
+}
+
+bool testCholeskyIndefinite()
+{
+  bool success = true;
+  Dune::LFECholesky<double> cholesky;
+
+  // indefinite: eigenvalues 3 and -1
+  Dune::LFEMatrix<double> indefinite;
+  indefinite.resize(2, 2);
+  indefinite(0,0) = indefinite(1,1) = 1.0;
+  indefinite(1,0) = 2.0;
+  if (cholesky.factorize(indefinite))
+  {
+    std::cout << "Cholesky factorization accepted an indefinite matrix" << std::endl;
+    success = false;
+  }
+
+  // positive semidefinite, but singular
+  Dune::LFEMatrix<double> singular;
+  singular.resize(3, 3);
+  for (unsigned int i=0; i<3; ++i)
+    for (unsigned int j=0; j<=i; ++j)
+      singular(i,j) = 1.0;
+  if (cholesky.factorize(singular))
+  {
+    std::cout << "Cholesky factorization accepted a singular matrix" << std::endl;
+    success = false;
+  }
+  return success;
+}
+
+int main(int argc, char** argv)
+{
+  bool success = true;
+
+  const unsigned int bs = Dune::LFEMatrix<double>::blockSize;
+  for (unsigned int n : { 1u, 2u, 5u, bs-1, bs, bs+1, 2*bs+3, 9*bs+1 })
+  {
+    success = testInvert(n) and success;
+    success = testSolve(n) and success;
+    success = testCholesky(n) and success;
+  }
+  success = testCholeskyIndefinite() and success;
+  success = testThreads(5*bs+7) and success;
+
+  Dune::LFEMatrix<double> singular;
+  singular.resize(3, 3);
+  singular(0,0) = singular(1,1) = 1.0;
+  if (singular.invert())
+  {
+    std::cout << "Singular matrix was inverted" << std::endl;
+    success = false;
+  }
+
+  return success ? 0 : 1;
+}
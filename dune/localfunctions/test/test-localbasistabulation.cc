@@ -0,0 +1,209 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasistabulation.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/monomial/monomiallocalbasis.hh>
+
+/** \file
+ * \brief Tests for LocalBasisTabulation and LocalBasisTabulationCache
+ *
+ * The tabulated data is compared to direct evaluation of the basis at the
+ * quadrature points.
+ */
+
+double TOL = 1e-12;
+
+template<class T>
+bool isAligned(const T* p, std::size_t alignment)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+template<class LB>
+bool testTabulation(const LB& basis, const Dune::GeometryType& gt, int order,
+                    bool withHessians, const std::string& name)
+{
+  typedef Dune::LocalBasisTabulation<LB> Tabulation;
+  typedef typename LB::Traits Traits;
+  const int dim = Traits::dimDomain;
+
+  bool success = true;
+  const auto& quad = Dune::QuadratureRules<typename Traits::DomainFieldType,dim>::rule(gt, order);
+  Tabulation tabulation(basis, quad, withHessians);
+
+  if (tabulation.size() != basis.size() or tabulation.numPoints() != quad.size())
+  {
+    std::cout << "Tabulation of " << name << " has wrong size" << std::endl;
+    return false;
+  }
+
+  const std::size_t alignment = Tabulation::alignment;
+  if (not isAligned(tabulation.values(0).data(), alignment)
+      or not isAligned(tabulation.jacobians(0).data(), alignment)
+      or (withHessians and not isAligned(tabulation.hessians(0).data(), alignment)))
+  {
+    std::cout << "Tabulation of " << name << " is not aligned" << std::endl;
+    success = false;
+  }
+
+  std::vector<typename Traits::RangeType> values;
+  std::vector<typename Traits::JacobianType> jacobians;
+  std::vector<typename Traits::RangeType> partials;
+  for (std::size_t q=0; q<quad.size(); ++q)
+  {
+    const auto& x = quad[q].position();
+    basis.evaluateFunction(x, values);
+    basis.evaluateJacobian(x, jacobians);
+
+    for (std::size_t i=0; i<basis.size(); ++i)
+      for (int m=0; m<Traits::dimRange; ++m)
+      {
+        if (std::abs(tabulation.values(q)[i][m] - values[i][m]) > TOL)
+        {
+          std::cout << "Tabulated value of shape function " << i << " of " << name
+                    << " at " << x << " is wrong" << std::endl;
+          success = false;
+        }
+
+        for (int a=0; a<dim; ++a)
+          if (std::abs(tabulation.jacobians(q)[i][m][a] - jacobians[i][m][a]) > TOL)
+          {
+            std::cout << "Tabulated Jacobian of shape function " << i << " of " << name
+                      << " at " << x << " is wrong" << std::endl;
+            success = false;
+          }
+      }
+
+    if (not withHessians)
+      continue;
+
+    for (int a=0; a<dim; ++a)
+      for (int b=0; b<dim; ++b)
+      {
+        std::array<unsigned int,dim> direction;
+        direction.fill(0);
+        ++direction[a];
+        ++direction[b];
+        basis.partial(direction, x, partials);
+
+        for (std::size_t i=0; i<basis.size(); ++i)
+          for (int m=0; m<Traits::dimRange; ++m)
+            if (std::abs(tabulation.hessians(q)[i][m][a][b] - partials[i][m]) > TOL)
+            {
+              std::cout << "Tabulated Hessian entry (" << a << "," << b << ") of shape function "
+                        << i << " of " << name << " at " << x << " is wrong" << std::endl;
+              success = false;
+            }
+      }
+  }
+
+  return success;
+}
+
+template<class LB>
+bool testCache(const LB& basis, const Dune::GeometryType& gt, const std::string& name)
+{
+  typedef Dune::LocalBasisTabulationCache<LB> Cache;
+  typedef typename Cache::Tabulation Tabulation;
+
+  bool success = true;
+  Cache cache(basis);
+
+  // request the same tabulations concurrently from several threads
+  const int numThreads = 4;
+  const int maxOrder = 6;
+  std::vector<std::array<const Tabulation*,maxOrder+1> > results(numThreads);
+  std::vector<std::thread> threads;
+  for (int t=0; t<numThreads; ++t)
+    threads.emplace_back([&, t]() {
+      for (int order=0; order<=maxOrder; ++order)
+        results[t][order] = &cache.get(gt, order);
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int order=0; order<=maxOrder; ++order)
+  {
+    for (int t=1; t<numThreads; ++t)
+      if (results[t][order] != results[0][order])
+      {
+        std::cout << "Cache for " << name << " returns different tabulations for order "
+                  << order << std::endl;
+        success = false;
+      }
+
+    const auto& quad = Dune::QuadratureRules<typename Tabulation::DomainFieldType,Tabulation::Traits::dimDomain>::rule(gt, order);
+    if (results[0][order]->numPoints() != quad.size())
+    {
+      std::cout << "Cache for " << name << " returns a tabulation for the wrong rule" << std::endl;
+      success = false;
+    }
+  }
+
+  // the cache owns its basis, the one it was created from may go away
+  std::unique_ptr<Cache> ownCache;
+  {
+    const LB copy(basis);
+    ownCache.reset(new Cache(copy));
+  }
+  const Tabulation& tabulation = ownCache->get(gt, 2);
+  const Tabulation& expected = cache.get(gt, 2);
+  for (std::size_t q=0; q<tabulation.numPoints(); ++q)
+    for (std::size_t i=0; i<tabulation.size(); ++i)
+      if ((tabulation.values(q)[i] - expected.values(q)[i]).two_norm() > TOL)
+      {
+        std::cout << "Cache for " << name << " tabulates a different basis once "
+                  << "the original basis is gone" << std::endl;
+        success = false;
+      }
+
+  return success;
+}
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  Dune::GeometryType triangle, cube2, cube3;
+  triangle.makeTriangle();
+  cube2.makeCube(2);
+  cube3.makeCube(3);
+
+  Dune::Pk2DLocalBasis<double,double,3> pk2d;
+  success = testTabulation(pk2d, triangle, 4, true, "Pk2D<3>") and success;
+  success = testCache(pk2d, triangle, "Pk2D<3>") and success;
+
+  Dune::MonomialLocalBasis<double,double,2,3> monomial;
+  success = testTabulation(monomial, cube2, 3, true, "Monomial<2,3>") and success;
+
+  Dune::QkLocalBasis<double,double,2,3> qk;
+  success = testTabulation(qk, cube3, 4, false, "Q2 in 3d") and success;
+  success = testCache(qk, cube3, "Q2 in 3d") and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
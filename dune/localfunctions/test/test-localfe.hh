@@ -241,6 +241,91 @@ bool testJacobian(const FE& fe, unsigned order = 2)
   return success;
 }
 
+// check whether the batched evaluation agrees with pointwise evaluation
+template<class FE>
+bool testBatchEvaluation(const FE& fe, bool testJacobians, unsigned order = 2)
+{
+  typedef typename FE::Traits::LocalBasisType LB;
+  typedef typename LB::Traits::DomainType DomainType;
+
+  bool success = true;
+
+  // Collect a set of test points
+  const auto& quad = Dune::QuadratureRules<double,LB::Traits::dimDomain>::rule(fe.type(),order);
+  std::vector<DomainType> points;
+  for (std::size_t q=0; q<quad.size(); q++)
+    points.push_back(quad[q].position());
+
+  const std::size_t size = fe.localBasis().size();
+
+  std::vector<typename LB::Traits::RangeType> batchValues, values;
+  Dune::evaluateFunctionBatch(fe.localBasis(), points, batchValues);
+  if (batchValues.size() != points.size()*size)
+  {
+    std::cout << "Bug in evaluateFunctionBatch() for finite element type "
+              << Dune::className(fe) << std::endl;
+    std::cout << "    Result has size " << batchValues.size()
+              << " for " << points.size() << " points and "
+              << size << " shape functions" << std::endl;
+    std::cout << std::endl;
+    return false;
+  }
+
+  for (std::size_t q=0; q<points.size(); q++)
+  {
+    fe.localBasis().evaluateFunction(points[q], values);
+    for (std::size_t i=0; i<size; i++)
+      for (int l=0; l<LB::Traits::dimRange; l++)
+        if (std::abs(batchValues[q*size+i][l]-values[i][l]) > TOL)
+        {
+          std::cout << "Bug in evaluateFunctionBatch() for finite element type "
+                    << Dune::className(fe) << std::endl;
+          std::cout << "    Shape function " << i << " component " << l
+                    << " at position " << points[q] << " is " << batchValues[q*size+i][l]
+                    << ", but " << values[i][l] << " is expected." << std::endl;
+          std::cout << std::endl;
+          success = false;
+        }
+  }
+
+  if (not testJacobians)
+    return success;
+
+  std::vector<typename LB::Traits::JacobianType> batchJacobians, jacobians;
+  Dune::evaluateJacobianBatch(fe.localBasis(), points, batchJacobians);
+  if (batchJacobians.size() != points.size()*size)
+  {
+    std::cout << "Bug in evaluateJacobianBatch() for finite element type "
+              << Dune::className(fe) << std::endl;
+    std::cout << "    Result has size " << batchJacobians.size()
+              << " for " << points.size() << " points and "
+              << size << " shape functions" << std::endl;
+    std::cout << std::endl;
+    return false;
+  }
+
+  for (std::size_t q=0; q<points.size(); q++)
+  {
+    fe.localBasis().evaluateJacobian(points[q], jacobians);
+    for (std::size_t i=0; i<size; i++)
+      for (int l=0; l<LB::Traits::dimRange; l++)
+        for (int k=0; k<LB::Traits::dimDomain; k++)
+          if (std::abs(batchJacobians[q*size+i][l][k]-jacobians[i][l][k]) > TOL)
+          {
+            std::cout << "Bug in evaluateJacobianBatch() for finite element type "
+                      << Dune::className(fe) << std::endl;
+            std::cout << "    Derivative of shape function " << i << " component " << l
+                      << " in direction " << k << " at position " << points[q]
+                      << " is " << batchJacobians[q*size+i][l][k] << ", but "
+                      << jacobians[i][l][k] << " is expected." << std::endl;
+            std::cout << std::endl;
+            success = false;
+          }
+  }
+
+  return success;
+}
+
 /** \brief Helper class to test the 'evaluate' method
  *
  * It implements a static loop over the available diff orders
@@ -670,6 +755,10 @@ bool testFE(const FE& fe, char disabledTests = DisableNone, unsigned order = 2)
     success = (FE::Traits::LocalBasisType::Traits::diffOrder == 0) and success;
   }
 
+  success = testBatchEvaluation<FE>(fe, not (disabledTests & DisableJacobian), order) and success;
+  // enough points to be split into several blocks by the batched evaluation
+  success = testBatchEvaluation<FE>(fe, not (disabledTests & DisableJacobian), 15) and success;
+
   if (not (disabledTests & DisableEvaluate))
   {
     success = TestEvaluate<FE::Traits::LocalBasisType::Traits::diffOrder>::test(fe, TOL, jacobianTOL, order) and success;
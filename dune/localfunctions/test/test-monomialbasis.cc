@@ -0,0 +1,275 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+#include <dune/localfunctions/utility/monomialbasis.hh>
+#include <dune/localfunctions/utility/multiindex.hh>
+
+/** \file
+ * \brief Test the evaluation of selected partial derivatives of the
+ *        monomial bases
+ *
+ * The partial derivatives of one order have to agree with the last entries
+ * of the blocks computed by the evaluation of all derivatives up to this
+ * order, and a single partial derivative with the derivative of the
+ * monomial x^alpha. The Jacobians and partial derivatives of a polynomial
+ * basis, which are computed from them, are compared to finite differences.
+ * Orders beyond the size tables have to be rejected.
+ */
+
+using namespace Dune;
+
+double TOL = 1e-10;
+
+template<int dim>
+FieldVector<double,dim> testPoint()
+{
+  FieldVector<double,dim> x;
+  for (int i=0; i<dim; ++i)
+    x[i] = 0.15 + 0.1*i;
+  return x;
+}
+
+// all multi-indices beta of order deriv
+template<int dim>
+void multiIndices(unsigned int deriv, unsigned int d, std::array<unsigned int,dim>& beta,
+                  std::vector<std::array<unsigned int,dim> >& result)
+{
+  if (d == dim)
+  {
+    if (deriv == 0)
+      result.push_back(beta);
+    return;
+  }
+  for (unsigned int k=0; k<=deriv; ++k)
+  {
+    beta[d] = k;
+    multiIndices<dim>(deriv-k, d+1, beta, result);
+  }
+}
+
+template<class Topology>
+bool testPartials(unsigned int order, unsigned int maxDeriv)
+{
+  const int dim = Topology::dimension;
+  typedef MonomialBasis<Topology,double> Basis;
+  Basis basis(order);
+  const FieldVector<double,dim> x = testPoint<dim>();
+  const unsigned int size = basis.size();
+
+  bool success = true;
+  for (unsigned int deriv=0; deriv<=maxDeriv; ++deriv)
+  {
+    const unsigned int block = basis.derivSize(deriv);
+    const unsigned int partialSize = basis.partialSize(deriv);
+    std::vector<double> all(block*size), partials(partialSize*size);
+    basis.evaluate(deriv, x, all.data());
+    basis.evaluatePartials(deriv, x, partials.data());
+
+    for (unsigned int j=0; j<size; ++j)
+      for (unsigned int k=0; k<partialSize; ++k)
+        if (std::abs(partials[j*partialSize+k] - all[j*block+block-partialSize+k]) > TOL)
+        {
+          std::cout << "Partial derivative " << k << " of order " << deriv << " of monomial " << j
+                    << " of order " << order << " on " << Topology::name() << " is "
+                    << partials[j*partialSize+k] << " instead of " << all[j*block+block-partialSize+k]
+                    << std::endl;
+          success = false;
+        }
+  }
+  return success;
+}
+
+// compare a single partial derivative to the derivative of x^alpha
+template<class Topology>
+bool testPartial(unsigned int order, unsigned int maxDeriv)
+{
+  const int dim = Topology::dimension;
+  typedef MultiIndex<dim,double> MI;
+  MonomialBasis<Topology,double> basis(order);
+  MonomialBasis<Topology,MI> miBasis(order);
+  const unsigned int size = basis.size();
+
+  std::vector<FieldVector<MI,1> > alpha(size);
+  FieldVector<MI,dim> mx;
+  for (int i=0; i<dim; ++i)
+    mx[i].set(i);
+  miBasis.evaluate(mx, alpha);
+
+  const FieldVector<double,dim> x = testPoint<dim>();
+  bool success = true;
+  for (unsigned int deriv=0; deriv<=maxDeriv; ++deriv)
+  {
+    std::array<unsigned int,dim> beta;
+    std::vector<std::array<unsigned int,dim> > betas;
+    multiIndices<dim>(deriv, 0, beta, betas);
+    for (const auto& b : betas)
+    {
+      std::vector<double> values(size);
+      basis.evaluatePartial(b, x, values.data());
+      for (unsigned int j=0; j<size; ++j)
+      {
+        double expected = 1;
+        for (int i=0; i<dim; ++i)
+        {
+          int a = alpha[j][0].z(i);
+          for (unsigned int k=0; k<b[i]; ++k, --a)
+            expected *= a;
+          if (a > 0)
+            expected *= std::pow(x[i], a);
+        }
+        if (std::abs(values[j] - expected) > TOL)
+        {
+          std::cout << "Partial derivative of order " << deriv << " of monomial " << j
+                    << " of order " << order << " on " << Topology::name() << " is "
+                    << values[j] << " instead of " << expected << std::endl;
+          success = false;
+        }
+      }
+    }
+  }
+  return success;
+}
+
+// Jacobians and partial derivatives of an orthonormal basis by finite differences
+template<class Topology>
+bool testPolynomialBasis(unsigned int order)
+{
+  const int dim = Topology::dimension;
+  typedef OrthonormalBasisFactory<dim,double,double> BasisFactory;
+  typedef typename BasisFactory::Object Basis;
+  typedef typename Basis::Traits Traits;
+  const Basis& basis = *BasisFactory::template create<Topology>(order);
+
+  const double h = 1e-5;
+  const FieldVector<double,dim> x = testPoint<dim>();
+  std::vector<typename Traits::JacobianType> jacobians;
+  basis.evaluateJacobian(x, jacobians);
+
+  bool success = true;
+  for (int d=0; d<dim; ++d)
+  {
+    FieldVector<double,dim> up = x, down = x;
+    up[d] += h;
+    down[d] -= h;
+    std::vector<typename Traits::RangeType> upValues, downValues, partials;
+    basis.evaluateFunction(up, upValues);
+    basis.evaluateFunction(down, downValues);
+
+    std::array<unsigned int,dim> direction;
+    direction.fill(0);
+    direction[d] = 1;
+    basis.partial(direction, x, partials);
+
+    std::vector<typename Traits::JacobianType> upJacobians, downJacobians;
+    basis.evaluateJacobian(up, upJacobians);
+    basis.evaluateJacobian(down, downJacobians);
+
+    for (unsigned int i=0; i<basis.size(); ++i)
+    {
+      const double fd = (upValues[i][0] - downValues[i][0]) / (2*h);
+      if (std::abs(jacobians[i][0][d] - fd) > 1e-6 or std::abs(partials[i][0] - jacobians[i][0][d]) > TOL)
+      {
+        std::cout << "Derivative " << d << " of shape function " << i << " of order " << order
+                  << " on " << Topology::name() << " is " << jacobians[i][0][d]
+                  << " (partial " << partials[i][0] << ") instead of " << fd << std::endl;
+        success = false;
+      }
+
+      // second derivatives
+      for (int e=0; e<dim; ++e)
+      {
+        std::array<unsigned int,dim> second = direction;
+        ++second[e];
+        std::vector<typename Traits::RangeType> secondPartials;
+        basis.partial(second, x, secondPartials);
+        const double fd2 = (upJacobians[i][0][e] - downJacobians[i][0][e]) / (2*h);
+        if (std::abs(secondPartials[i][0] - fd2) > 1e-6)
+        {
+          std::cout << "Second derivative (" << d << "," << e << ") of shape function " << i
+                    << " of order " << order << " on " << Topology::name() << " is "
+                    << secondPartials[i][0] << " instead of " << fd2 << std::endl;
+          success = false;
+        }
+      }
+    }
+  }
+  BasisFactory::release(&basis);
+  return success;
+}
+
+// a basis of an order beyond the size table must throw instead of reading past it
+template<class Topology>
+bool testMaxOrder()
+{
+  const unsigned int maxOrder = MonomialBasisSize<Topology>::instance().maxOrder();
+  MonomialBasis<Topology,double> basis(maxOrder);
+  if (basis.size() == 0)
+    return false;
+  try
+  {
+    MonomialBasis<Topology,double> tooHigh(maxOrder+1);
+    std::cout << "Monomial basis of order " << maxOrder+1 << " on " << Topology::name()
+              << " beyond the size table was accepted" << std::endl;
+    return false;
+  }
+  catch (const Dune::RangeError&)
+  {
+    return true;
+  }
+}
+
+int main(int argc, char** argv) try
+{
+  using Impl::Point;
+  using Impl::Prism;
+  using Impl::Pyramid;
+
+  bool success = true;
+  for (unsigned int order=0; order<=4; ++order)
+  {
+    success = testPartials<Prism<Point> >(order, 3) and success;
+    success = testPartials<Pyramid<Prism<Point> > >(order, 3) and success;
+    success = testPartials<Prism<Prism<Point> > >(order, 3) and success;
+    success = testPartials<Pyramid<Pyramid<Prism<Point> > > >(order, 3) and success;
+    success = testPartials<Prism<Pyramid<Prism<Point> > > >(order, 3) and success;
+    success = testPartials<Prism<Prism<Prism<Point> > > >(order, 3) and success;
+    // the derivatives of the pyramid are evaluated completely
+    success = testPartials<Pyramid<Prism<Prism<Point> > > >(order, 1) and success;
+
+    success = testPartial<Prism<Point> >(order, 3) and success;
+    success = testPartial<Pyramid<Prism<Point> > >(order, 3) and success;
+    success = testPartial<Prism<Prism<Point> > >(order, 3) and success;
+    success = testPartial<Pyramid<Pyramid<Prism<Point> > > >(order, 3) and success;
+    success = testPartial<Prism<Pyramid<Prism<Point> > > >(order, 3) and success;
+    success = testPartial<Prism<Prism<Prism<Point> > > >(order, 3) and success;
+  }
+
+  success = testPolynomialBasis<Pyramid<Prism<Point> > >(3) and success;
+  success = testPolynomialBasis<Pyramid<Pyramid<Prism<Point> > > >(3) and success;
+  success = testPolynomialBasis<Prism<Prism<Prism<Point> > > >(2) and success;
+
+  success = testMaxOrder<Pyramid<Pyramid<Prism<Point> > > >() and success;
+  success = testMaxOrder<Prism<Prism<Prism<Prism<Point> > > > >() and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
@@ -2,12 +2,18 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <dune/geometry/type.hh>
 #include <dune/geometry/quadraturerules.hh>
 
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/basisprint.hh>
+#include <dune/localfunctions/utility/monomialbasis.hh>
 #include <dune/localfunctions/orthonormal/orthonormalbasis.hh>
+#include <dune/localfunctions/orthonormal/orthonormalcompute.hh>
 
 /**
  * \file
@@ -99,6 +105,58 @@ bool test(unsigned int order)
   return ret;
 }
 
+// The coefficients computed by ONBMatrix, applied to the monomials, have
+// to be orthonormal under a quadrature rule exact for their products.
+template <class Topology>
+bool testMatrix(unsigned int order)
+{
+  const unsigned int dim = Topology::dimension;
+  bool ret = true;
+  Dune::GeometryType gt(Topology::id, dim);
+  for (unsigned int o = 0; o <= order; ++o)
+  {
+    ONBCompute::ONBMatrix<Topology,ComputeField> matrix(o);
+    Dune::StandardMonomialBasis<dim,double> monomials(o);
+    const unsigned int size = monomials.size();
+
+    // row i holds the coefficients of the i-th orthonormal function
+    std::vector< std::vector< double > > coefficients(size, std::vector< double >(size));
+    for (unsigned int i = 0; i < size; ++i)
+      matrix.row(i, coefficients[i]);
+
+    std::vector< Dune::FieldVector< double, 1 > > m(size);
+    std::vector< double > phi(size);
+    std::vector< double > gram(size * size, 0.0);
+    const Dune::QuadratureRule<double,dim> &quadrature =
+      Dune::QuadratureRules<double,dim>::rule(gt,2*o);
+    for (const auto &point : quadrature)
+    {
+      monomials.evaluate(point.position(), m);
+      for (unsigned int i = 0; i < size; ++i)
+      {
+        phi[i] = 0;
+        for (unsigned int j = 0; j < size; ++j)
+          phi[i] += coefficients[i][j] * m[j][0];
+      }
+      for (unsigned int i = 0; i < size; ++i)
+        for (unsigned int j = 0; j < size; ++j)
+          gram[i*size + j] += point.weight() * phi[i] * phi[j];
+    }
+
+    double error = 0;
+    for (unsigned int i = 0; i < size; ++i)
+      for (unsigned int j = 0; j < size; ++j)
+        error = std::max(error, std::abs(gram[i*size + j] - double(i == j)));
+    if (error > 1e-8)
+    {
+      std::cout << "ONBMatrix for " << Topology::name() << " of order " << o
+                << " is not orthonormal, error " << error << std::endl;
+      ret = false;
+    }
+  }
+  return ret;
+}
+
 int main ( int argc, char **argv )
 {
   using namespace Dune;
@@ -112,9 +170,15 @@ int main ( int argc, char **argv )
               << "Using default order of " << order << std::endl;
   }
 #ifdef TOPOLOGY
-  return (test<TOPOLOGY>(order) ? 0 : 1 );
+  return ((test<TOPOLOGY>(order) & testMatrix<TOPOLOGY>(order)) ? 0 : 1 );
 #else
   bool tests = true;
+  tests &= testMatrix<Prism<Prism<Point> > > (order);
+  tests &= testMatrix<Pyramid<Pyramid<Point> > > (order);
+  tests &= testMatrix<Prism<Pyramid<Pyramid<Point> > > > (order);
+  tests &= testMatrix<Pyramid<Prism<Prism<Point> > > > (order);
+  tests &= testMatrix<Pyramid<Pyramid<Pyramid<Point> > > > (order);
+
   tests &= test<Prism<Point> > (order);
   tests &= test<Pyramid<Point> > (order);
 
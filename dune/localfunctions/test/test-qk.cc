@@ -0,0 +1,445 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/lagrange/gausslobattopoints.hh>
+#include <dune/localfunctions/lagrange/qk.hh>
+#include <dune/localfunctions/lagrange/qkspectral.hh>
+
+/** \file
+ * \brief Tests for the tensor-product evaluation of QkLocalBasis
+ *
+ * The evaluation on tensor-product grids and the sum factorization are
+ * compared to pointwise evaluation at the same points. Partial derivatives
+ * of any order are compared to finite differences of the derivatives of
+ * one order less and to the evaluation of all derivatives up to an order.
+ * For the Gauss-Lobatto nodes the mass matrix computed with the
+ * Gauss-Lobatto quadrature has to be diagonal, and the collocated
+ * derivatives of the spectral element have to agree with the Jacobians
+ * of the basis.
+ */
+
+double TOL = 1e-10;
+
+template<int k, int d>
+bool testTensorGrid()
+{
+  typedef Dune::QkLocalBasis<double,double,k,d> LocalBasis;
+  typedef typename LocalBasis::Traits::DomainType DomainType;
+  typedef typename LocalBasis::Traits::RangeType RangeType;
+  typedef typename LocalBasis::Traits::JacobianType JacobianType;
+
+  bool success = true;
+  LocalBasis basis;
+  const std::size_t size = basis.size();
+
+  // use Gauss points of different orders in the different directions
+  Dune::GeometryType line;
+  line.makeLine();
+  std::array<std::vector<double>,d> points1D;
+  for (int j=0; j<d; j++)
+  {
+    const auto& quad = Dune::QuadratureRules<double,1>::rule(line, k+j);
+    for (std::size_t q=0; q<quad.size(); q++)
+      points1D[j].push_back(quad[q].position()[0]);
+  }
+
+  // random coefficients of a linear combination
+  std::vector<double> coefficients(size);
+  for (std::size_t i=0; i<size; i++)
+    coefficients[i] = (1.0*std::rand()) / RAND_MAX - 0.5;
+
+  std::vector<RangeType> gridValues, gridCombination, values;
+  std::vector<JacobianType> gridJacobians, gridCombinationJacobians, jacobians;
+  basis.evaluateFunctionTensorGrid(points1D, gridValues);
+  basis.evaluateJacobianTensorGrid(points1D, gridJacobians);
+  basis.evaluateFunctionTensorGrid(points1D, coefficients, gridCombination);
+  basis.evaluateJacobianTensorGrid(points1D, coefficients, gridCombinationJacobians);
+
+  std::size_t numPoints = gridCombination.size();
+  if (gridValues.size() != numPoints*size or gridJacobians.size() != numPoints*size
+      or gridCombinationJacobians.size() != numPoints)
+  {
+    std::cout << "Tensor grid evaluation of Q" << k << " in " << d << "d "
+              << "returns vectors of inconsistent size" << std::endl;
+    return false;
+  }
+
+  std::array<std::size_t,d> index;
+  std::fill(index.begin(), index.end(), 0);
+  for (std::size_t q=0; q<numPoints; q++)
+  {
+    DomainType x;
+    for (int j=0; j<d; j++)
+      x[j] = points1D[j][index[j]];
+
+    basis.evaluateFunction(x, values);
+    basis.evaluateJacobian(x, jacobians);
+
+    RangeType combination(0);
+    JacobianType combinationJacobian(0);
+    for (std::size_t i=0; i<size; i++)
+    {
+      combination.axpy(coefficients[i], values[i]);
+      combinationJacobian.axpy(coefficients[i], jacobians[i]);
+
+      if (std::abs(gridValues[q*size+i][0] - values[i][0]) > TOL)
+      {
+        std::cout << "Bug in evaluateFunctionTensorGrid() for Q" << k << " in " << d << "d: "
+                  << "shape function " << i << " at " << x << " is " << gridValues[q*size+i]
+                  << ", but " << values[i] << " is expected." << std::endl;
+        success = false;
+      }
+
+      for (int m=0; m<d; m++)
+        if (std::abs(gridJacobians[q*size+i][0][m] - jacobians[i][0][m]) > TOL)
+        {
+          std::cout << "Bug in evaluateJacobianTensorGrid() for Q" << k << " in " << d << "d: "
+                    << "derivative " << m << " of shape function " << i << " at " << x
+                    << " is " << gridJacobians[q*size+i][0][m] << ", but "
+                    << jacobians[i][0][m] << " is expected." << std::endl;
+          success = false;
+        }
+    }
+
+    if (std::abs(gridCombination[q][0] - combination[0]) > TOL)
+    {
+      std::cout << "Bug in sum factorized evaluateFunctionTensorGrid() for Q" << k << " in " << d << "d: "
+                << "value at " << x << " is " << gridCombination[q] << ", but "
+                << combination << " is expected." << std::endl;
+      success = false;
+    }
+
+    for (int m=0; m<d; m++)
+      if (std::abs(gridCombinationJacobians[q][0][m] - combinationJacobian[0][m]) > TOL)
+      {
+        std::cout << "Bug in sum factorized evaluateJacobianTensorGrid() for Q" << k << " in " << d << "d: "
+                  << "derivative " << m << " at " << x << " is " << gridCombinationJacobians[q][0][m]
+                  << ", but " << combinationJacobian[0][m] << " is expected." << std::endl;
+        success = false;
+      }
+
+    // increment the grid index, first direction runs fastest
+    for (int j=0; j<d; j++)
+    {
+      if (++index[j] < points1D[j].size())
+        break;
+      index[j] = 0;
+    }
+  }
+
+  return success;
+}
+
+template<int k, int d>
+bool testPartials(unsigned int maxOrder)
+{
+  typedef Dune::QkLocalBasis<double,double,k,d> LocalBasis;
+  typedef typename LocalBasis::Traits::DomainType DomainType;
+  typedef typename LocalBasis::Traits::RangeType RangeType;
+  typedef typename LocalBasis::Traits::JacobianType JacobianType;
+
+  bool success = true;
+  LocalBasis basis;
+  const std::size_t size = basis.size();
+  const double delta = 1e-5;
+
+  DomainType x;
+  for (int j=0; j<d; j++)
+    x[j] = 0.2 + 0.15*j;
+
+  std::vector<RangeType> all, values;
+  std::vector<JacobianType> jacobians;
+  basis.evaluatePartials(maxOrder, x, all);
+  basis.evaluateFunction(x, values);
+  basis.evaluateJacobian(x, jacobians);
+
+  const auto orders = LocalBasis::partialOrders(maxOrder);
+  if (all.size() != orders.size()*size)
+  {
+    std::cout << "evaluatePartials() for Q" << k << " in " << d << "d "
+              << "returns a vector of inconsistent size" << std::endl;
+    return false;
+  }
+
+  for (std::size_t l=0; l<orders.size(); l++)
+  {
+    const auto& order = orders[l];
+    std::vector<RangeType> partials;
+    basis.partial(order, x, partials);
+
+    // expected values: the function values and Jacobians for orders 0 and 1,
+    // finite differences of a derivative of one order less otherwise
+    std::vector<double> expected(size);
+    const unsigned int totalOrder = std::accumulate(order.begin(), order.end(), 0u);
+    const int direction = std::find_if(order.begin(), order.end(), [](unsigned int o) { return o > 0; }) - order.begin();
+    for (std::size_t i=0; i<size; i++)
+    {
+      if (totalOrder == 0)
+        expected[i] = values[i][0];
+      else if (totalOrder == 1)
+        expected[i] = jacobians[i][0][direction];
+    }
+    if (totalOrder > 1)
+    {
+      auto lower = order;
+      lower[direction]--;
+      DomainType up = x, down = x;
+      up[direction] += delta;
+      down[direction] -= delta;
+      std::vector<RangeType> upPartials, downPartials;
+      basis.partial(lower, up, upPartials);
+      basis.partial(lower, down, downPartials);
+      for (std::size_t i=0; i<size; i++)
+        expected[i] = (upPartials[i][0] - downPartials[i][0]) / (2*delta);
+    }
+
+    for (std::size_t i=0; i<size; i++)
+    {
+      if (std::abs(partials[i][0] - expected[i]) > 1e-5*(1 + std::abs(expected[i])))
+      {
+        std::cout << "Bug in partial() for Q" << k << " in " << d << "d: "
+                  << "derivative " << l << " of shape function " << i << " is "
+                  << partials[i][0] << ", but " << expected[i] << " is expected." << std::endl;
+        success = false;
+      }
+      if (std::abs(all[l*size+i][0] - partials[i][0]) > TOL)
+      {
+        std::cout << "Bug in evaluatePartials() for Q" << k << " in " << d << "d: "
+                  << "derivative " << l << " of shape function " << i << " is "
+                  << all[l*size+i][0] << ", but " << partials[i][0] << " is expected." << std::endl;
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
+// product of polynomials of a given order in each direction
+template<class DomainType, class RangeType>
+struct Polynomial
+{
+  Polynomial (int order) : order_(order) {}
+
+  void evaluate (const DomainType& x, RangeType& y) const
+  {
+    y = 1.0;
+    for (std::size_t j=0; j<x.size(); j++)
+      y[0] *= std::pow(x[j], order_) - 0.5*x[j];
+  }
+
+  int order_;
+};
+
+template<int k, int d>
+bool testGaussLobatto()
+{
+  typedef Dune::QkGaussLobattoLocalFiniteElement<double,double,d,k> FiniteElement;
+  typedef typename FiniteElement::Traits::LocalBasisType::Traits::DomainType DomainType;
+  typedef typename FiniteElement::Traits::LocalBasisType::Traits::RangeType RangeType;
+
+  bool success = true;
+  FiniteElement fe;
+  const std::size_t size = fe.size();
+
+  // the quadrature rule is exact for polynomials of degree 2k-1
+  const Dune::GaussLobattoPoints<double> gaussLobatto(k);
+  const auto& points = gaussLobatto.points();
+  const auto& weights = gaussLobatto.weights();
+  for (int p=0; p<2*k; p++)
+  {
+    double integral = 0;
+    for (int q=0; q<=k; q++)
+      integral += weights[q]*std::pow(points[q], p);
+    if (std::abs(integral - 1.0/(p+1)) > TOL)
+    {
+      std::cout << "Gauss-Lobatto rule of order " << k << " integrates x^" << p
+                << " to " << integral << " instead of " << 1.0/(p+1) << std::endl;
+      success = false;
+    }
+  }
+
+  // mass matrix with the Gauss-Lobatto rule on the tensor grid of the nodes
+  std::array<std::vector<double>,d> points1D;
+  points1D.fill(points);
+  std::vector<RangeType> values;
+  fe.localBasis().evaluateFunctionTensorGrid(points1D, values);
+  std::vector<double> mass(size*size, 0.0);
+  for (std::size_t q=0; q<size; q++)
+  {
+    double weight = 1;
+    for (std::size_t j=0, rest=q; j<d; j++, rest/=k+1)
+      weight *= weights[rest%(k+1)];
+    for (std::size_t i=0; i<size; i++)
+      for (std::size_t l=0; l<size; l++)
+        mass[i*size+l] += weight*values[q*size+i][0]*values[q*size+l][0];
+  }
+  for (std::size_t i=0; i<size; i++)
+    for (std::size_t l=0; l<size; l++)
+      if (i != l and std::abs(mass[i*size+l]) > TOL)
+      {
+        std::cout << "Lumped mass matrix of Q" << k << " in " << d << "d with Gauss-Lobatto nodes "
+                  << "has the off-diagonal entry " << mass[i*size+l] << " at (" << i << "," << l << ")"
+                  << std::endl;
+        success = false;
+      }
+
+  // the interpolation reproduces polynomials of order k in each direction
+  const Polynomial<DomainType,RangeType> f(k);
+  std::vector<double> coefficients;
+  fe.localInterpolation().interpolate(f, coefficients);
+  DomainType x;
+  for (int j=0; j<d; j++)
+    x[j] = 0.3 + 0.1*j;
+  fe.localBasis().evaluateFunction(x, values);
+  double value = 0;
+  for (std::size_t i=0; i<size; i++)
+    value += coefficients[i]*values[i][0];
+  RangeType expected;
+  f.evaluate(x, expected);
+  if (std::abs(value - expected[0]) > TOL)
+  {
+    std::cout << "Interpolation of Q" << k << " in " << d << "d with Gauss-Lobatto nodes "
+              << "gives " << value << " instead of " << expected << std::endl;
+    success = false;
+  }
+
+  return success;
+}
+
+template<int k, int d>
+bool testSpectral()
+{
+  typedef Dune::QkSpectralLocalFiniteElement<double,double,d,k> FiniteElement;
+  typedef typename FiniteElement::Traits::LocalBasisType::Traits::JacobianType JacobianType;
+  typedef typename FiniteElement::Gradient Gradient;
+
+  bool success = true;
+  FiniteElement fe;
+  const std::size_t size = fe.size();
+
+  // the differentiation matrix holds the derivatives of the basis in 1d
+  const Dune::QkGaussLobattoLocalFiniteElement<double,double,1,k> fe1D;
+  const auto& points = FiniteElement::points1D();
+  const auto& matrix = FiniteElement::differentiationMatrix1D();
+  std::vector<typename Dune::QkGaussLobattoLocalFiniteElement<double,double,1,k>::Traits::LocalBasisType::Traits::JacobianType> jacobians1D;
+  double weightSum = 0;
+  for (int q=0; q<=k; q++)
+  {
+    weightSum += FiniteElement::weights1D()[q];
+    fe1D.localBasis().evaluateJacobian(Dune::FieldVector<double,1>(points[q]), jacobians1D);
+    for (int i=0; i<=k; i++)
+      if (std::abs(matrix[q*(k+1)+i] - jacobians1D[i][0][0]) > 1e-8*(1 + std::abs(matrix[q*(k+1)+i])))
+      {
+        std::cout << "Differentiation matrix of order " << k << " has the entry " << matrix[q*(k+1)+i]
+                  << " at (" << q << "," << i << "), but " << jacobians1D[i][0][0] << " is expected." << std::endl;
+        success = false;
+      }
+  }
+  if (std::abs(weightSum - 1) > TOL)
+  {
+    std::cout << "Gauss-Lobatto weights of order " << k << " sum up to " << weightSum << std::endl;
+    success = false;
+  }
+
+  // gradients at the nodes, and their transpose, compared to the Jacobians of the basis
+  std::vector<double> coefficients(size), fluxCoefficients(size);
+  for (std::size_t i=0; i<size; i++)
+    coefficients[i] = (1.0*std::rand()) / RAND_MAX - 0.5;
+  std::vector<Gradient> gradients, fluxes(size);
+  FiniteElement::gradient(coefficients, gradients);
+
+  std::array<std::vector<double>,d> grid;
+  grid.fill(points);
+  std::vector<JacobianType> jacobians;
+  fe.localBasis().evaluateJacobianTensorGrid(grid, jacobians);
+
+  std::vector<double> transposed, expectedTransposed(size, 0.0);
+  for (std::size_t q=0; q<size; q++)
+    for (int m=0; m<d; m++)
+      fluxes[q][m] = (1.0*std::rand()) / RAND_MAX - 0.5;
+  FiniteElement::gradientTransposed(fluxes, transposed);
+
+  for (std::size_t q=0; q<size; q++)
+  {
+    Gradient expected(0.0);
+    for (std::size_t i=0; i<size; i++)
+    {
+      expected.axpy(coefficients[i], jacobians[q*size+i][0]);
+      expectedTransposed[i] += fluxes[q]*jacobians[q*size+i][0];
+    }
+    if ((gradients[q] - expected).infinity_norm() > 1e-8)
+    {
+      std::cout << "Gradient of the spectral element of order " << k << " in " << d << "d "
+                << "at node " << q << " is " << gradients[q] << ", but " << expected
+                << " is expected." << std::endl;
+      success = false;
+    }
+  }
+  for (std::size_t i=0; i<size; i++)
+    if (std::abs(transposed[i] - expectedTransposed[i]) > 1e-8)
+    {
+      std::cout << "Transposed gradient of the spectral element of order " << k << " in " << d << "d "
+                << "is " << transposed[i] << " for shape function " << i << ", but "
+                << expectedTransposed[i] << " is expected." << std::endl;
+      success = false;
+    }
+
+  return success;
+}
+
+int main(int argc, char** argv) try
+{
+  bool success = true;
+
+  success = testTensorGrid<0,1>() and success;
+  success = testTensorGrid<1,1>() and success;
+  success = testTensorGrid<4,1>() and success;
+  success = testTensorGrid<0,2>() and success;
+  success = testTensorGrid<1,2>() and success;
+  success = testTensorGrid<3,2>() and success;
+  success = testTensorGrid<1,3>() and success;
+  success = testTensorGrid<2,3>() and success;
+  success = testTensorGrid<5,3>() and success;
+
+  success = testPartials<0,2>(2) and success;
+  success = testPartials<1,2>(3) and success;
+  success = testPartials<3,1>(5) and success;
+  success = testPartials<4,2>(5) and success;
+  success = testPartials<2,3>(4) and success;
+
+  success = testGaussLobatto<1,2>() and success;
+  success = testGaussLobatto<4,1>() and success;
+  success = testGaussLobatto<5,2>() and success;
+  success = testGaussLobatto<3,3>() and success;
+
+  success = testSpectral<1,1>() and success;
+  success = testSpectral<6,1>() and success;
+  success = testSpectral<4,2>() and success;
+  success = testSpectral<3,3>() and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
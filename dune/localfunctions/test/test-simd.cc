@@ -0,0 +1,301 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/typetraits.hh>
+
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1cube2d/brezzidouglasmarini1cube2dlocalbasis.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini1simplex2d/brezzidouglasmarini1simplex2dlocalbasis.hh>
+#include <dune/localfunctions/brezzidouglasmarini/brezzidouglasmarini2cube2d/brezzidouglasmarini2cube2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/p0/p0localbasis.hh>
+#include <dune/localfunctions/lagrange/p1/p1localbasis.hh>
+#include <dune/localfunctions/lagrange/pk2d/pk2dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/pk3d/pk3dlocalbasis.hh>
+#include <dune/localfunctions/lagrange/q1/q1localbasis.hh>
+#include <dune/localfunctions/lagrange/qk/qklocalbasis.hh>
+#include <dune/localfunctions/monomial/monomiallocalbasis.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas02d/raviartthomas02dlocalbasis.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas12d/raviartthomas12dlocalbasis.hh>
+#include <dune/localfunctions/raviartthomas/raviartthomas1cube2d/raviartthomas1cube2dlocalbasis.hh>
+#include <dune/localfunctions/refined/refinedp0/refinedp0localbasis.hh>
+
+/** \file
+ * \brief Instantiate local bases with a SIMD field type
+ *
+ * Each lane of the SIMD evaluation has to agree with the scalar evaluation
+ * at the corresponding point. The SIMD type used here is deliberately
+ * strict: it cannot be converted to double, and comparisons yield masks
+ * that cannot be converted to bool. Any implicit scalar conversion or
+ * branch on coordinate values in a basis therefore fails to compile.
+ */
+
+namespace SimdTest
+{
+
+  static const std::size_t lanes = 4;
+
+  //! Mask type resulting from comparisons of Simd vectors
+  struct Mask
+  {
+    std::array<bool,lanes> m;
+
+    friend Mask operator! (const Mask& a)
+    {
+      Mask r;
+      for (std::size_t l=0; l<lanes; ++l)
+        r.m[l] = not a.m[l];
+      return r;
+    }
+
+    friend Mask operator&& (const Mask& a, const Mask& b)
+    {
+      Mask r;
+      for (std::size_t l=0; l<lanes; ++l)
+        r.m[l] = a.m[l] and b.m[l];
+      return r;
+    }
+
+    friend Mask operator|| (const Mask& a, const Mask& b)
+    {
+      Mask r;
+      for (std::size_t l=0; l<lanes; ++l)
+        r.m[l] = a.m[l] or b.m[l];
+      return r;
+    }
+  };
+
+  //! A minimal SIMD vector of doubles
+  struct Simd
+  {
+    std::array<double,lanes> v;
+
+    Simd () = default;
+
+    // broadcast a scalar to all lanes
+    template<class T, class = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    Simd (T s)
+    {
+      v.fill(s);
+    }
+
+    Simd& operator+= (const Simd& b) { for (std::size_t l=0; l<lanes; ++l) v[l] += b.v[l]; return *this; }
+    Simd& operator-= (const Simd& b) { for (std::size_t l=0; l<lanes; ++l) v[l] -= b.v[l]; return *this; }
+    Simd& operator*= (const Simd& b) { for (std::size_t l=0; l<lanes; ++l) v[l] *= b.v[l]; return *this; }
+    Simd& operator/= (const Simd& b) { for (std::size_t l=0; l<lanes; ++l) v[l] /= b.v[l]; return *this; }
+
+    friend Simd operator- (Simd a) { for (auto& x : a.v) x = -x; return a; }
+    friend Simd operator+ (const Simd& a) { return a; }
+    friend Simd operator+ (Simd a, const Simd& b) { return a += b; }
+    friend Simd operator- (Simd a, const Simd& b) { return a -= b; }
+    friend Simd operator* (Simd a, const Simd& b) { return a *= b; }
+    friend Simd operator/ (Simd a, const Simd& b) { return a /= b; }
+
+#define SIMDTEST_COMPARISON(OP)                            \
+    friend Mask operator OP (const Simd& a, const Simd& b) \
+    {                                                      \
+      Mask r;                                              \
+      for (std::size_t l=0; l<lanes; ++l)                  \
+        r.m[l] = a.v[l] OP b.v[l];                         \
+      return r;                                            \
+    }
+    SIMDTEST_COMPARISON(<)
+    SIMDTEST_COMPARISON(<=)
+    SIMDTEST_COMPARISON(>)
+    SIMDTEST_COMPARISON(>=)
+    SIMDTEST_COMPARISON(==)
+    SIMDTEST_COMPARISON(!=)
+#undef SIMDTEST_COMPARISON
+  };
+
+  //! Lane-wise selection, found by argument-dependent lookup
+  inline Simd cond (const Mask& mask, const Simd& a, const Simd& b)
+  {
+    Simd r;
+    for (std::size_t l=0; l<lanes; ++l)
+      r.v[l] = mask.m[l] ? a.v[l] : b.v[l];
+    return r;
+  }
+
+  inline double lane (std::size_t l, const Simd& a)
+  {
+    return a.v[l];
+  }
+
+  inline double lane (std::size_t l, double a)
+  {
+    return a;
+  }
+
+  inline std::ostream& operator<< (std::ostream& s, const Simd& a)
+  {
+    s << "<";
+    for (std::size_t l=0; l<lanes; ++l)
+      s << (l ? " " : "") << a.v[l];
+    return s << ">";
+  }
+
+} // end namespace SimdTest
+
+namespace Dune
+{
+  template<>
+  struct IsNumber<SimdTest::Simd> : public std::true_type {};
+}
+
+double TOL = 1e-12;
+
+// Flatten values and Jacobians into a list of field entries
+template<int n, class K>
+void flatten (const Dune::FieldVector<K,n>& v, std::vector<K>& out)
+{
+  for (int i=0; i<n; ++i)
+    out.push_back(v[i]);
+}
+
+template<int n, int m, class K>
+void flatten (const Dune::FieldMatrix<K,n,m>& v, std::vector<K>& out)
+{
+  for (int i=0; i<n; ++i)
+    for (int j=0; j<m; ++j)
+      out.push_back(v[i][j]);
+}
+
+template<class ScalarBasis, class SimdBasis, class Points>
+bool testSimd (const ScalarBasis& scalarBasis, const SimdBasis& simdBasis,
+               const Points& points, const std::string& name)
+{
+  using SimdTest::lanes;
+  using SimdTest::Simd;
+  const int dim = ScalarBasis::Traits::dimDomain;
+  bool success = true;
+
+  // evaluate the points in batches, one per lane of a SIMD point
+  assert(points.size() % lanes == 0);
+  for (std::size_t first=0; first<points.size(); first+=lanes)
+  {
+    typename SimdBasis::Traits::DomainType simdPoint;
+    for (int j=0; j<dim; ++j)
+      for (std::size_t l=0; l<lanes; ++l)
+        simdPoint[j].v[l] = points[first+l][j];
+
+    std::vector<typename SimdBasis::Traits::RangeType> simdValues;
+    std::vector<typename SimdBasis::Traits::JacobianType> simdJacobians;
+    simdBasis.evaluateFunction(simdPoint, simdValues);
+    simdBasis.evaluateJacobian(simdPoint, simdJacobians);
+
+    std::vector<Simd> simdEntries;
+    for (const auto& v : simdValues)
+      flatten(v, simdEntries);
+    for (const auto& j : simdJacobians)
+      flatten(j, simdEntries);
+
+    for (std::size_t l=0; l<lanes; ++l)
+    {
+      std::vector<typename ScalarBasis::Traits::RangeType> values;
+      std::vector<typename ScalarBasis::Traits::JacobianType> jacobians;
+      scalarBasis.evaluateFunction(points[first+l], values);
+      scalarBasis.evaluateJacobian(points[first+l], jacobians);
+
+      std::vector<double> entries;
+      for (const auto& v : values)
+        flatten(v, entries);
+      for (const auto& j : jacobians)
+        flatten(j, entries);
+
+      if (entries.size() != simdEntries.size())
+      {
+        std::cout << "SIMD evaluation of " << name << " returns the wrong number of entries" << std::endl;
+        return false;
+      }
+
+      for (std::size_t i=0; i<entries.size(); ++i)
+        if (std::abs(lane(l, simdEntries[i]) - entries[i]) > TOL)
+        {
+          std::cout << "Lane " << l << " of the SIMD evaluation of " << name
+                    << " differs from the scalar evaluation at " << points[first+l]
+                    << " (entry " << i << ": " << lane(l, simdEntries[i])
+                    << " instead of " << entries[i] << ")" << std::endl;
+          success = false;
+        }
+    }
+  }
+
+  return success;
+}
+
+template<template<class,class> class Basis, class Points>
+bool testSimd (const Points& points, const std::string& name)
+{
+  return testSimd(Basis<double,double>(), Basis<SimdTest::Simd,SimdTest::Simd>(), points, name);
+}
+
+int main(int argc, char** argv) try
+{
+  using SimdTest::Simd;
+  bool success = true;
+
+  // points in the reference simplices, chosen to lie in different
+  // subelements of the refined elements
+  std::array<Dune::FieldVector<double,1>,4> points1d = {{ {0.1}, {0.4}, {0.6}, {0.9} }};
+  std::array<Dune::FieldVector<double,2>,4> points2d = {{ {0.1, 0.2}, {0.6, 0.1}, {0.2, 0.7}, {0.3, 0.4} }};
+  std::array<Dune::FieldVector<double,3>,4> points3d = {{ {0.1, 0.2, 0.1}, {0.6, 0.1, 0.2},
+                                                          {0.1, 0.2, 0.6}, {0.3, 0.1, 0.2} }};
+  // one point in each of the eight subsimplices of the refined tetrahedron, i.e.,
+  // the four corners and the parts 4-7 of the octahedron, which is split along
+  // the planes x+y=1/2 and y+z=1/2
+  std::array<Dune::FieldVector<double,3>,8> refinedPoints3d = {{ {0.1, 0.1, 0.1}, {0.6, 0.1, 0.1},
+                                                                 {0.1, 0.6, 0.1}, {0.1, 0.1, 0.6},
+                                                                 {0.2, 0.1, 0.3}, {0.4, 0.2, 0.1},
+                                                                 {0.1, 0.2, 0.4}, {0.3, 0.3, 0.3} }};
+
+  success = testSimd(Dune::P0LocalBasis<double,double,2>(), Dune::P0LocalBasis<Simd,Simd,2>(),
+                     points2d, "P0") and success;
+  success = testSimd(Dune::P1LocalBasis<double,double,3>(), Dune::P1LocalBasis<Simd,Simd,3>(),
+                     points3d, "P1") and success;
+  success = testSimd(Dune::Q1LocalBasis<double,double,2>(), Dune::Q1LocalBasis<Simd,Simd,2>(),
+                     points2d, "Q1") and success;
+  success = testSimd(Dune::Pk2DLocalBasis<double,double,3>(), Dune::Pk2DLocalBasis<Simd,Simd,3>(),
+                     points2d, "Pk2D") and success;
+  success = testSimd(Dune::Pk3DLocalBasis<double,double,3>(), Dune::Pk3DLocalBasis<Simd,Simd,3>(),
+                     points3d, "Pk3D") and success;
+  success = testSimd(Dune::QkLocalBasis<double,double,2,1>(), Dune::QkLocalBasis<Simd,Simd,2,1>(),
+                     points1d, "Qk in 1d") and success;
+  success = testSimd(Dune::QkLocalBasis<double,double,3,3>(), Dune::QkLocalBasis<Simd,Simd,3,3>(),
+                     points3d, "Qk in 3d") and success;
+  success = testSimd(Dune::MonomialLocalBasis<double,double,2,3>(), Dune::MonomialLocalBasis<Simd,Simd,2,3>(),
+                     points2d, "Monomial") and success;
+
+  success = testSimd<Dune::RT02DLocalBasis>(points2d, "RT02D") and success;
+  success = testSimd<Dune::RT12DLocalBasis>(points2d, "RT12D") and success;
+  success = testSimd<Dune::RT1Cube2DLocalBasis>(points2d, "RT1Cube2D") and success;
+  success = testSimd<Dune::BDM1Simplex2DLocalBasis>(points2d, "BDM1Simplex2D") and success;
+  success = testSimd<Dune::BDM1Cube2DLocalBasis>(points2d, "BDM1Cube2D") and success;
+  success = testSimd<Dune::BDM2Cube2DLocalBasis>(points2d, "BDM2Cube2D") and success;
+
+  success = testSimd(Dune::RefinedP0LocalBasis<double,double,1>(), Dune::RefinedP0LocalBasis<Simd,Simd,1>(),
+                     points1d, "RefinedP0 in 1d") and success;
+  success = testSimd(Dune::RefinedP0LocalBasis<double,double,2>(), Dune::RefinedP0LocalBasis<Simd,Simd,2>(),
+                     points2d, "RefinedP0 in 2d") and success;
+  success = testSimd(Dune::RefinedP0LocalBasis<double,double,3>(), Dune::RefinedP0LocalBasis<Simd,Simd,3>(),
+                     refinedPoints3d, "RefinedP0 in 3d") and success;
+
+  return success ? 0 : 1;
+}
+catch (const Dune::Exception& e)
+{
+  std::cout << e << std::endl;
+  return 1;
+}
@@ -18,6 +18,7 @@
 // Lagrange type elements
 #include <dune/localfunctions/lagrange.hh>
 #include <dune/localfunctions/lagrange/equidistantpoints.hh>
+#include <dune/localfunctions/lagrange/lobattopoints.hh>
 
 // DG type elements
 #include <dune/localfunctions/orthonormal.hh>
@@ -49,6 +50,33 @@ int main(int argc, char** argv) try
     lagrangeCube(Dune::GeometryType(Dune::GeometryType::cube, 2), order);
     TEST_FE(lagrangeCube);
   }
+  std::cout << "Testing LagrangeLocalFiniteElement<LobattoPointSet> on 3d"
+            << " simplex elements with double precision" << std::endl;
+  for (unsigned int order=1; order<=6; ++order)
+  {
+    std::cout << "order : " << order << std::endl;
+    Dune::LagrangeLocalFiniteElement<Dune::LobattoPointSet,3,double,double>
+    lagrangeSimplex(Dune::GeometryType(Dune::GeometryType::simplex, 3), order);
+    TEST_FE(lagrangeSimplex);
+  }
+  std::cout << "Testing LagrangeLocalFiniteElement<LobattoPointSet> on 3d"
+            << " prism elements with double precision" << std::endl;
+  for (unsigned int order=1; order<=3; ++order)
+  {
+    std::cout << "order : " << order << std::endl;
+    Dune::LagrangeLocalFiniteElement<Dune::LobattoPointSet,3,double,double>
+    lagrangePrism(Dune::GeometryType(Dune::GeometryType::prism, 3), order);
+    TEST_FE(lagrangePrism);
+  }
+  std::cout << "Testing LagrangeLocalFiniteElement<LobattoPointSet> on 2d"
+            << " cube elements with double precision" << std::endl;
+  for (unsigned int order=1; order<=4; ++order)
+  {
+    std::cout << "order : " << order << std::endl;
+    Dune::LagrangeLocalFiniteElement<Dune::LobattoPointSet,2,double,double>
+    lagrangeCube(Dune::GeometryType(Dune::GeometryType::cube, 2), order);
+    TEST_FE(lagrangeCube);
+  }
 #if HAVE_GMP
   std::cout << "Testing LagrangeLocalFiniteElement<EquidistantPointSet> on 2d"
             << " simplex elements with higher precision" << std::endl;
@@ -79,6 +107,22 @@ int main(int argc, char** argv) try
     Dune::L2LocalFiniteElement<FE> dglagrangeCube(Dune::GeometryType(Dune::GeometryType::cube, 3), order);
     TEST_FE(dglagrangeCube);
   }
+  {
+    // interpolations with the same basis, key, and quadrature share the projection
+    typedef Dune::LagrangeLocalFiniteElement<Dune::EquidistantPointSet,3,double,double> FE;
+    const Dune::GeometryType cube(Dune::GeometryType::cube, 3);
+    Dune::L2LocalFiniteElement<FE> first(cube, 2), second(cube, 2), other(cube, 1);
+    if (not first.localInterpolation().sharesProjection(second.localInterpolation()))
+    {
+      std::cout << "L2 interpolations of the same basis do not share the projection" << std::endl;
+      success = false;
+    }
+    if (first.localInterpolation().sharesProjection(other.localInterpolation()))
+    {
+      std::cout << "L2 interpolations of different bases share the projection" << std::endl;
+      success = false;
+    }
+  }
 #if HAVE_GMP
   std::cout << "Testing OrthonormalFiniteElement on 3d"
             << " prism elements with higher precision" << std::endl;
@@ -0,0 +1,314 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_BASISCOEFFICIENTCACHE_HH
+#define DUNE_BASISCOEFFICIENTCACHE_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define DUNE_BASISCOEFFICIENTCACHE_HAVE_GETPID 1
+#endif
+
+namespace Dune
+{
+
+  /**
+   * \brief A dense coefficient matrix with the row interface used by
+   *        SparseCoeffMatrix::fill
+   *
+   * It holds the coefficients of a basis in the storage field, either
+   * copied from the matrix computed by a basis factory or loaded from
+   * the BasisCoefficientCache.
+   **/
+  template< class Field >
+  class StoredBasisMatrix
+  {
+  public:
+    StoredBasisMatrix ()
+      : rows_( 0 ), cols_( 0 )
+    {}
+
+    /** \brief copy the rows of a matrix providing rows(), cols() and row() */
+    template< class Matrix >
+    explicit StoredBasisMatrix ( const Matrix &matrix )
+    {
+      resize( matrix.rows(), matrix.cols() );
+      std::vector< Field > row( cols_ );
+      for( unsigned int r = 0; r < rows_; ++r )
+      {
+        matrix.row( r, row );
+        std::copy( row.begin(), row.end(), data_.begin() + r*cols_ );
+      }
+    }
+
+    void resize ( unsigned int rows, unsigned int cols )
+    {
+      rows_ = rows;
+      cols_ = cols;
+      data_.resize( rows*cols );
+    }
+
+    unsigned int rows () const { return rows_; }
+    unsigned int cols () const { return cols_; }
+
+    template< class Vector >
+    void row ( const unsigned int row, Vector &vec ) const
+    {
+      assert( row < rows_ && vec.size() >= cols_ );
+      for( unsigned int c = 0; c < cols_; ++c )
+        vec[ c ] = data_[ row*cols_ + c ];
+    }
+
+    Field *data () { return data_.data(); }
+    const Field *data () const { return data_.data(); }
+
+  private:
+    unsigned int rows_, cols_;
+    std::vector< Field > data_;
+  };
+
+  /**
+   * \brief Versioned on-disk cache for the coefficient matrices of the
+   *        generic bases
+   *
+   * Constructing the coefficients of the generic Lagrange, Raviart-Thomas,
+   * and orthonormal bases requires inverting a dense matrix, possibly in
+   * multi-precision arithmetic. With a cache directory set, the basis
+   * factories store the resulting coefficients in one binary file per
+   * basis and read this file on later constructions instead of recomputing,
+   * also across processes.
+   *
+   * The cache directory is taken from the environment variable
+   * DUNE_LOCALFUNCTIONS_CACHE_DIR or set by setDirectory(). Without a
+   * directory, caching is disabled. The directory has to exist.
+   *
+   * Each file records a format version, the byte order, the size of the
+   * storage field, and the complete key. A file not matching all of these
+   * is ignored and replaced. Besides the topology, the order and the field
+   * types, the key contains the version of dune-localfunctions and the
+   * revision Factory::coefficientRevision of the computation in the basis
+   * factory, which has to be increased whenever the factory computes
+   * different coefficients. So entries of older builds are not reused. Files are written to a temporary name and
+   * renamed, so concurrent writers on a shared file system never produce a
+   * partially written entry.
+   *
+   * Only storage fields that are trivially copyable can be cached, e.g.,
+   * float and double; the key is built by the basis factory and encodes
+   * the topology, the order, the field types and the point set.
+   **/
+  class BasisCoefficientCache
+  {
+  public:
+    //! version of the file format, increase when the layout changes
+    static const std::uint32_t version = 1;
+
+    //! current cache directory, empty if caching is disabled
+    static std::string directory ()
+    {
+      return directoryStorage();
+    }
+
+    /** \brief set the cache directory, an empty string disables caching
+     *
+     * This is not thread safe and should be called before any generic
+     * local finite element is constructed.
+     **/
+    static void setDirectory ( const std::string &directory )
+    {
+      directoryStorage() = directory;
+    }
+
+    static bool enabled ()
+    {
+      return !directory().empty();
+    }
+
+    //! name of the cache file for a given key
+    static std::string fileName ( const std::string &key )
+    {
+      // 64-bit FNV-1a hash of the key
+      std::uint64_t hash = 14695981039346656037ull;
+      for( const char c : key )
+      {
+        hash ^= static_cast< unsigned char >( c );
+        hash *= 1099511628211ull;
+      }
+      std::ostringstream name;
+      name << directory() << "/dune-localfunctions-basis-" << std::hex << hash << ".bin";
+      return name.str();
+    }
+
+    /** \brief build a key from the basis factory, the topology, the key of the factory and the fields
+     *
+     * The key includes the module version and Factory::coefficientRevision.
+     * Returns an empty string if the basis cannot be cached.
+     **/
+    template< class Factory, class Key, class SF, class CF >
+    static std::string key ( unsigned int topologyId, unsigned int dim, const Key &key )
+    {
+      if( !cacheable< Key, SF >() )
+        return std::string();
+      std::ostringstream s;
+#ifdef DUNE_LOCALFUNCTIONS_VERSION
+      s << DUNE_LOCALFUNCTIONS_VERSION << ";";
+#endif
+      s << typeid( Factory ).name() << ";" << Factory::coefficientRevision
+        << ";" << typeid( SF ).name() << ";" << typeid( CF ).name()
+        << ";" << dim << ";" << topologyId << ";" << key;
+      return s.str();
+    }
+
+    /** \brief load the matrix stored for a key
+     *
+     * \returns false if caching is disabled or no valid entry exists
+     **/
+    template< class Field >
+    static bool load ( const std::string &key, StoredBasisMatrix< Field > &matrix )
+    {
+      if( !enabled() || key.empty() )
+        return false;
+
+      std::ifstream in( fileName( key ), std::ios::binary );
+      if( !in )
+        return false;
+      if( read( in, key, matrix ) )
+        return true;
+      matrix.resize( 0, 0 );
+      return false;
+    }
+
+    /** \brief store the matrix for a key
+     *
+     * Errors while writing only mean that the entry is not cached, so they
+     * are silently ignored.
+     **/
+    template< class Field >
+    static void store ( const std::string &key, const StoredBasisMatrix< Field > &matrix )
+    {
+      if( !enabled() || key.empty() )
+        return;
+
+      const std::string name = fileName( key );
+      std::ostringstream tmpName;
+      tmpName << name << ".tmp";
+#if DUNE_BASISCOEFFICIENTCACHE_HAVE_GETPID
+      tmpName << "." << ::getpid();
+#endif
+      tmpName << "." << static_cast< const void * >( &matrix );
+
+      {
+        std::ofstream out( tmpName.str(), std::ios::binary );
+        if( !out )
+          return;
+        out.write( magic(), magicSize );
+        writeValue( out, std::uint32_t( version ) );
+        writeValue( out, byteOrderMark() );
+        writeValue( out, std::uint32_t( sizeof( Field ) ) );
+        writeValue( out, std::uint32_t( key.size() ) );
+        out.write( key.data(), key.size() );
+        writeValue( out, std::uint32_t( matrix.rows() ) );
+        writeValue( out, std::uint32_t( matrix.cols() ) );
+        out.write( reinterpret_cast< const char * >( matrix.data() ),
+                   sizeof( Field ) * matrix.rows() * matrix.cols() );
+        if( !out )
+        {
+          out.close();
+          std::remove( tmpName.str().c_str() );
+          return;
+        }
+      }
+      if( std::rename( tmpName.str().c_str(), name.c_str() ) != 0 )
+        std::remove( tmpName.str().c_str() );
+    }
+
+  private:
+    static const std::size_t magicSize = 8;
+
+    static const char *magic ()
+    {
+      return "DUNELFBC";
+    }
+
+    static std::uint32_t byteOrderMark ()
+    {
+      return 0x01020304u;
+    }
+
+    template< class Key, class SF >
+    static constexpr bool cacheable ()
+    {
+      return std::is_arithmetic< Key >::value && std::is_trivially_copyable< SF >::value;
+    }
+
+    static std::string &directoryStorage ()
+    {
+      static std::string directory = []() {
+          const char *env = std::getenv( "DUNE_LOCALFUNCTIONS_CACHE_DIR" );
+          return std::string( env ? env : "" );
+        }();
+      return directory;
+    }
+
+    template< class T >
+    static void writeValue ( std::ostream &out, const T &value )
+    {
+      out.write( reinterpret_cast< const char * >( &value ), sizeof( T ) );
+    }
+
+    template< class T >
+    static bool readValue ( std::istream &in, T &value )
+    {
+      return bool( in.read( reinterpret_cast< char * >( &value ), sizeof( T ) ) );
+    }
+
+    // validate the header and read the coefficients directly into the
+    // matrix, the stream buffers the small header reads
+    template< class Field >
+    static bool read ( std::istream &in, const std::string &key,
+                       StoredBasisMatrix< Field > &matrix )
+    {
+      char header[ magicSize ];
+      if( !in.read( header, magicSize ) || (std::memcmp( header, magic(), magicSize ) != 0) )
+        return false;
+
+      std::uint32_t fileVersion, mark, fieldSize, keySize, rows, cols;
+      if( !readValue( in, fileVersion ) || (fileVersion != version) )
+        return false;
+      if( !readValue( in, mark ) || (mark != byteOrderMark()) )
+        return false;
+      if( !readValue( in, fieldSize ) || (fieldSize != sizeof( Field )) )
+        return false;
+      if( !readValue( in, keySize ) || (keySize != key.size()) )
+        return false;
+      std::string fileKey( keySize, '\0' );
+      if( !in.read( &fileKey[ 0 ], keySize ) || (fileKey != key) )
+        return false;
+      if( !readValue( in, rows ) || !readValue( in, cols ) )
+        return false;
+
+      // check the size of the remaining data before allocating for it
+      const std::streamoff bytes = std::streamoff( sizeof( Field ) ) * rows * cols;
+      const std::streampos begin = in.tellg();
+      if( !in.seekg( 0, std::ios::end ) || (in.tellg() - begin != bytes) || !in.seekg( begin ) )
+        return false;
+
+      matrix.resize( rows, cols );
+      return bool( in.read( reinterpret_cast< char * >( matrix.data() ), bytes ) );
+    }
+  };
+
+}
+
+#endif // #ifndef DUNE_BASISCOEFFICIENTCACHE_HH
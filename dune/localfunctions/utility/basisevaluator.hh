@@ -54,19 +54,17 @@ namespace Dune
     MonomialEvaluator(const Basis &basis,unsigned int order,unsigned int size)
       : basis_(basis),
         order_(order),
-        size_(size),
-        container_(0)
+        size_(size)
     {}
     template <int deriv>
-    void resize()
+    void resize(Container &container) const
     {
       const int totalSize = Derivatives<Field,dimension,dimRange,deriv,derivative>::size*size_;
-      container_.resize(totalSize);
+      container.resize(totalSize);
     }
     MonomialEvaluator(const MonomialEvaluator&);
     const Basis &basis_;
     unsigned int order_,size_;
-    Container container_;
   };
 
 
@@ -142,18 +140,24 @@ namespace Dune
     StandardEvaluator(const Basis &basis)
       : Base(basis,basis.order(),basis.size())
     {}
+    /** \brief evaluate the basis into the scratch storage container
+     *
+     *  The evaluator itself holds no scratch storage, so one evaluator can
+     *  be used concurrently by several threads with separate containers.
+     *  The returned iterator refers to the container.
+     */
     template <unsigned int deriv,class DVector>
-    typename Iterator<deriv>::All evaluate(const DVector &x)
+    typename Iterator<deriv>::All evaluate(const DVector &x, Container &container) const
     {
-      Base::template resize<deriv>();
-      basis_.template evaluate<deriv>(x,&(container_[0]));
-      return typename Iterator<deriv>::All(container_);
+      Base::template resize<deriv>(container);
+      basis_.template evaluate<deriv>(x,&(container[0]));
+      return typename Iterator<deriv>::All(container);
     }
-    typename Iterator<0>::Integrate integrate()
+    typename Iterator<0>::Integrate integrate(Container &container) const
     {
-      Base::template resize<0>();
-      basis_.integrate(&(container_[0]));
-      return typename Iterator<0>::Integrate(container_);
+      Base::template resize<0>(container);
+      basis_.integrate(&(container[0]));
+      return typename Iterator<0>::Integrate(container);
     }
 
   protected:
@@ -164,7 +168,6 @@ namespace Dune
   private:
     StandardEvaluator(const StandardEvaluator&);
     using Base::basis_;
-    using Base::container_;
   };
 
 #if 0 // OLD OLD
@@ -2,13 +2,27 @@
 // vi: set et ts=4 sw=2 sts=2:
 #ifndef DUNE_COEFFMATRIX_HH
 #define DUNE_COEFFMATRIX_HH
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <dune/common/fvector.hh>
+#include <dune/localfunctions/utility/constructionthreadpool.hh>
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/tensor.hh>
 
+#if HAVE_BLAS
+extern "C"
+{
+  // matrix-matrix product of the BLAS, see DenseCoeffMatrix::multMatrix
+  void dgemm_ ( const char *transa, const char *transb, const int *m, const int *n, const int *k,
+                const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+                const double *beta, double *c, const int *ldc );
+}
+#endif // HAVE_BLAS
+
 namespace Dune
 {
   /*************************************************
@@ -216,6 +230,32 @@ namespace Dune
                   << " full: " << numCols_*numRows_
                   << std::endl;
     }
+    // y = C x for the first numRows rows of C, where x is a matrix
+    // with numBase rows of length n and y has numRows rows of length n;
+    // the coefficients of these rows in columns numBase and above must vanish
+    template< class XField >
+    void multMatrix ( const XField *x, unsigned int numBase, std::size_t n,
+                      unsigned int numRows, XField *y ) const
+    {
+      assert( numRows <= numRows_ );
+      const unsigned int *skipIt = skip_;
+      for( unsigned int row = 0; row < numRows; ++row )
+      {
+        XField *yRow = y + row*n;
+        for( std::size_t k = 0; k < n; ++k )
+          yRow[ k ] = XField( 0 );
+        unsigned int j = 0;
+        for( const Field *pos = rows_[ row ]; pos != rows_[ row+1 ]; ++pos, ++skipIt )
+        {
+          j += *skipIt;
+          assert( j < numBase );
+          const XField c = *pos;
+          const XField *xRow = x + j*n;
+          for( std::size_t k = 0; k < n; ++k )
+            yRow[ k ] += c * xRow[ k ];
+        }
+      }
+    }
     // b += a*C[k]
     template <class Vector>
     void addRow( unsigned int k, const Field &a, Vector &b) const
@@ -257,6 +297,451 @@ namespace Dune
     unsigned int numRows_,numCols_;
   };
 
+  /*************************************************
+  * Dense coefficient matrix with the interface of
+  * SparseCoeffMatrix. The rows are stored row-major,
+  * padded to a multiple of the cache line and
+  * aligned to it. The product with the evaluated
+  * underlying basis is a plain matrix-matrix product
+  * on the contiguous coefficient and basis arrays
+  * without index indirection, so the compiler can
+  * vectorize it. This pays off for nearly dense
+  * matrices, e.g., for orthonormal and Lagrange
+  * bases of moderate order.
+  *************************************************/
+  template< class F , unsigned int bSize >
+  class DenseCoeffMatrix
+  {
+  public:
+    typedef F Field;
+    static const unsigned int blockSize = bSize;
+    typedef DenseCoeffMatrix<Field,blockSize> This;
+
+    DenseCoeffMatrix()
+      : offset_(0),
+        stride_(0),
+        numRows_(0),
+        numCols_(0)
+    {}
+
+    unsigned int size () const
+    {
+      return numRows_/blockSize;
+    }
+    unsigned int baseSize () const
+    {
+      return numCols_;
+    }
+
+    unsigned int rows () const
+    {
+      return numRows_;
+    }
+    unsigned int cols () const
+    {
+      return numCols_;
+    }
+
+    template< class Vector >
+    void row ( const unsigned int r, Vector &vec ) const
+    {
+      assert( r < numRows_ );
+      const Field *c = rowBegin( r );
+      for( unsigned int j = 0; j < numCols_; ++j )
+        vec[ j ] = c[ j ];
+    }
+
+    //! number of nonzero entries
+    std::size_t nonZeros () const
+    {
+      std::size_t nnz = 0;
+      for( unsigned int r = 0; r < numRows_; ++r )
+        for( unsigned int j = 0; j < numCols_; ++j )
+          if( rowBegin( r )[ j ] < Zero<Field>() || Zero<Field>() < rowBegin( r )[ j ] )
+            ++nnz;
+      return nnz;
+    }
+
+    template< class BasisIterator, class FF>
+    void mult ( const BasisIterator &x,
+                unsigned int numLsg,
+                FF *y ) const
+    {
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      assert( numLsg*blockSize <= (size_t)numRows_ );
+      const typename XDerivatives::Field *xData = data( x );
+      XDerivatives val;
+      unsigned int row = 0;
+      for( size_t i = 0; i < numLsg; ++i)
+      {
+        for( unsigned int r = 0; r < blockSize; ++r, ++row )
+        {
+          multRow( row, xData, val );
+          DerivativeAssign<XDerivatives,FF>::apply(r,val,*(y+i*XDerivatives::size*blockSize));
+        }
+      }
+    }
+    template< class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      typedef typename Vector::value_type YDerivatives;
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      size_t numLsg = y.size();
+      assert( numLsg*blockSize <= (size_t)numRows_ );
+      const typename XDerivatives::Field *xData = data( x );
+      XDerivatives val;
+      unsigned int row = 0;
+      for( size_t i = 0; i < numLsg; ++i)
+      {
+        for( unsigned int r = 0; r < blockSize; ++r, ++row )
+        {
+          multRow( row, xData, val );
+          DerivativeAssign<XDerivatives,YDerivatives>::apply(r,val,y[i]);
+        }
+      }
+    }
+    template <unsigned int deriv, class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      typedef typename Vector::value_type YDerivatives;
+      typedef typename BasisIterator::Derivatives XDerivatives;
+      typedef typename XDerivatives::Field XField;
+      typedef FieldVector<XField,YDerivatives::dimension> XLFETensor;
+      size_t numLsg = y.size();
+      assert( numLsg*blockSize <= (size_t)numRows_ );
+      const XField *xData = data( x );
+      XDerivatives val;
+      unsigned int row = 0;
+      for( size_t i = 0; i < numLsg; ++i)
+      {
+        XLFETensor tensor(XField(0));
+        for( unsigned int r = 0; r < blockSize; ++r, ++row )
+        {
+          multRow( row, xData, val );
+          LFETensorAxpy<XDerivatives,XLFETensor,deriv>::apply(r,XField(1),val,tensor);
+        }
+        field_cast(tensor,y[i]);
+      }
+    }
+
+    template< class RowMatrix >
+    void fill ( const RowMatrix &mat, bool verbose=false )
+    {
+      numRows_ = mat.rows();
+      numCols_ = mat.cols();
+
+      // pad the rows such that each row starts on a cache line
+      const unsigned int rowAlign = (alignment % sizeof(Field) == 0 ? alignment / sizeof(Field) : 1);
+      stride_ = (numCols_ + rowAlign - 1) / rowAlign * rowAlign;
+      coeff_.assign( std::size_t( numRows_ )*stride_ + rowAlign, Zero<Field>() );
+      const std::size_t misalign = reinterpret_cast<std::uintptr_t>( coeff_.data() ) % alignment;
+      offset_ = (misalign > 0 && (alignment - misalign) % sizeof(Field) == 0)
+                ? (alignment - misalign) / sizeof(Field) : 0;
+
+      // the rows are independent, blocks of rows are read in parallel
+      rowLength_.assign( numRows_, 0 );
+      const unsigned int rowBlock = 16;
+      ConstructionThreadPool::instance().parallelFor( (numRows_ + rowBlock - 1) / rowBlock, [ & ] ( std::size_t b ) {
+          std::vector<Field> row( numCols_ );
+          const unsigned int end = std::min( unsigned( b+1 )*rowBlock, numRows_ );
+          for( unsigned int r = b*rowBlock; r < end; ++r )
+          {
+            mat.row( r, row );
+            Field *c = rowBegin( r );
+            for( unsigned int j = 0; j < numCols_; ++j )
+            {
+              c[ j ] = row[ j ];
+              if( row[ j ] < Zero<Field>() || Zero<Field>() < row[ j ] )
+                rowLength_[ r ] = j+1;
+            }
+          }
+        } );
+
+      if (verbose)
+        std::cout << "Entries: " << nonZeros()
+                  << " full: " << numCols_*numRows_
+                  << std::endl;
+    }
+    //! release the storage
+    void clear ()
+    {
+      std::vector<Field>().swap( coeff_ );
+      std::vector<unsigned int>().swap( rowLength_ );
+      offset_ = 0;
+      stride_ = numRows_ = numCols_ = 0;
+    }
+
+    // y = C x for the first numRows rows of C, where x is a matrix
+    // with numBase rows of length n and y has numRows rows of length n;
+    // the coefficients of these rows in columns numBase and above must vanish
+    template< class XField >
+    void multMatrix ( const XField *x, unsigned int numBase, std::size_t n,
+                      unsigned int numRows, XField *y ) const
+    {
+      assert( numRows <= numRows_ );
+      gemm( rowBegin( 0 ), x, std::min( numBase, numCols_ ), n, numRows, y );
+    }
+    // b += a*C[k]
+    template <class Vector>
+    void addRow( unsigned int k, const Field &a, Vector &b) const
+    {
+      assert(k<numRows_);
+      assert(numCols_ <= b.size());
+      const Field *c = rowBegin( k );
+      for( unsigned int j = 0; j < numCols_; ++j )
+        b[j] += field_cast<typename Vector::value_type>( c[j]*a );  // field_cast
+    }
+
+  private:
+    static const std::size_t alignment = 64;
+    // number of independent partial sums in the product of one row
+    static const unsigned int lanes = 4;
+
+    DenseCoeffMatrix ( const This &other );
+    This &operator= (const This&);
+
+    const Field *rowBegin ( unsigned int r ) const
+    {
+      return coeff_.data() + offset_ + std::size_t( r )*stride_;
+    }
+    Field *rowBegin ( unsigned int r )
+    {
+      return coeff_.data() + offset_ + std::size_t( r )*stride_;
+    }
+
+    // the evaluated underlying basis as one contiguous array of numCols_ blocks
+    template< class BasisIterator >
+    static const typename BasisIterator::Derivatives::Field *data ( const BasisIterator &x )
+    {
+      return &((*x).block()[ 0 ]);
+    }
+
+    // blocked product of the coefficient rows c with the matrix x; the
+    // rows of y are computed in blocks of rowBlock rows and colBlock
+    // columns, so that the block of y stays in the L1 cache while the
+    // rows of x are streamed through it
+    template< class XField >
+    void gemm ( const Field *c, const XField *x, unsigned int numCols, std::size_t n,
+                unsigned int numRows, XField *y ) const
+    {
+      static const unsigned int rowBlock = 4;
+      static const std::size_t colBlock = 256;
+      for( unsigned int r0 = 0; r0 < numRows; r0 += rowBlock )
+      {
+        const unsigned int nr = std::min( rowBlock, numRows - r0 );
+        for( std::size_t k0 = 0; k0 < n; k0 += colBlock )
+        {
+          const std::size_t nk = std::min( colBlock, n - k0 );
+          for( unsigned int r = r0; r < r0+nr; ++r )
+            for( std::size_t k = 0; k < nk; ++k )
+              y[ r*n + k0 + k ] = XField( 0 );
+          for( unsigned int j = 0; j < numCols; ++j )
+          {
+            const XField *xRow = x + j*n + k0;
+            for( unsigned int r = r0; r < r0+nr; ++r )
+            {
+              const Field &cj = c[ std::size_t( r )*stride_ + j ];
+              if( !(cj < Zero<Field>() || Zero<Field>() < cj) )
+                continue;
+              XField *yRow = y + r*n + k0;
+              for( std::size_t k = 0; k < nk; ++k )
+                yRow[ k ] += cj * xRow[ k ];
+            }
+          }
+        }
+      }
+    }
+
+#if HAVE_BLAS
+    // with double precision use the optimized BLAS
+    void gemm ( const double *c, const double *x, unsigned int numCols, std::size_t n,
+                unsigned int numRows, double *y ) const
+    {
+      if( numRows == 0 || n == 0 )
+        return;
+      // y^T = x^T c^T in the column-major storage of BLAS
+      const char trans = 'N';
+      const int m = n, nn = numRows, k = numCols;
+      const int ldx = n, ldc = stride_, ldy = n;
+      const double one = 1, zero = 0;
+      dgemm_( &trans, &trans, &m, &nn, &k, &one, x, &ldx, c, &ldc, &zero, y, &ldy );
+    }
+#endif // HAVE_BLAS
+
+    // val = sum_j C[row][j] x_j, where x_j is the j-th block of derivatives
+    template< class XField, class XDerivatives >
+    void multRow ( unsigned int row, const XField *x, XDerivatives &val ) const
+    {
+      static const unsigned int D = XDerivatives::size;
+      const Field *c = rowBegin( row );
+
+      // independent partial sums over the columns, which the compiler
+      // maps onto vector registers
+      XField acc[ lanes ][ D ];
+      for( unsigned int l = 0; l < lanes; ++l )
+        for( unsigned int d = 0; d < D; ++d )
+          acc[ l ][ d ] = XField( 0 );
+
+      // trailing zeros are skipped, so that hierarchical bases only
+      // access the monomials of their own order
+      const unsigned int numCols = rowLength_[ row ];
+      const unsigned int full = numCols - numCols % lanes;
+      unsigned int j = 0;
+      for( ; j < full; j += lanes, x += lanes*D )
+        for( unsigned int l = 0; l < lanes; ++l )
+        {
+          const XField cj = c[ j+l ];
+          for( unsigned int d = 0; d < D; ++d )
+            acc[ l ][ d ] += cj * x[ l*D + d ];
+        }
+      for( ; j < numCols; ++j, x += D )
+      {
+        const XField cj = c[ j ];
+        for( unsigned int d = 0; d < D; ++d )
+          acc[ 0 ][ d ] += cj * x[ d ];
+      }
+
+      for( unsigned int d = 0; d < D; ++d )
+      {
+        XField sum = acc[ 0 ][ d ];
+        for( unsigned int l = 1; l < lanes; ++l )
+          sum += acc[ l ][ d ];
+        val.block()[ d ] = sum;
+      }
+    }
+
+    std::vector<Field> coeff_;
+    // number of columns up to the last nonzero entry in each row
+    std::vector<unsigned int> rowLength_;
+    std::size_t offset_;
+    unsigned int stride_;
+    unsigned int numRows_,numCols_;
+  };
+
+  /*************************************************
+  * Coefficient matrix choosing between the sparse
+  * and the dense storage when it is filled. Matrices
+  * with at least denseFillRatio() nonzero entries
+  * are stored densely, all others in the CRS format.
+  *************************************************/
+  template< class F , unsigned int bSize >
+  class AdaptiveCoeffMatrix
+  {
+  public:
+    typedef F Field;
+    static const unsigned int blockSize = bSize;
+    typedef AdaptiveCoeffMatrix<Field,blockSize> This;
+    typedef SparseCoeffMatrix<Field,blockSize> Sparse;
+    typedef DenseCoeffMatrix<Field,blockSize> Dense;
+
+    AdaptiveCoeffMatrix()
+      : isDense_(false)
+    {}
+
+    //! fraction of nonzero entries above which the dense storage is used
+    static double denseFillRatio ()
+    {
+      return 0.5;
+    }
+
+    //! whether the coefficients are stored densely
+    bool isDense () const
+    {
+      return isDense_;
+    }
+
+    unsigned int size () const
+    {
+      return isDense_ ? dense_.size() : sparse_.size();
+    }
+    unsigned int baseSize () const
+    {
+      return isDense_ ? dense_.baseSize() : sparse_.baseSize();
+    }
+
+    template< class BasisIterator, class FF>
+    void mult ( const BasisIterator &x,
+                unsigned int numLsg,
+                FF *y ) const
+    {
+      if( isDense_ )
+        dense_.mult( x, numLsg, y );
+      else
+        sparse_.mult( x, numLsg, y );
+    }
+    template< class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      if( isDense_ )
+        dense_.mult( x, y );
+      else
+        sparse_.mult( x, y );
+    }
+    template <unsigned int deriv, class BasisIterator, class Vector>
+    void mult ( const BasisIterator &x,
+                Vector &y ) const
+    {
+      if( isDense_ )
+        dense_.template mult<deriv>( x, y );
+      else
+        sparse_.template mult<deriv>( x, y );
+    }
+
+    template< class RowMatrix >
+    void fill ( const RowMatrix &mat, bool verbose=false )
+    {
+      // the rows of mat may be expensive to compute, so read them only
+      // once into the dense storage and convert if the matrix is sparse
+      dense_.fill( mat );
+      const double full = double( dense_.rows() )*dense_.cols();
+      const std::size_t nnz = dense_.nonZeros();
+      isDense_ = (full > 0) && (nnz >= denseFillRatio()*full);
+      if( !isDense_ )
+      {
+        sparse_.fill( dense_ );
+        dense_.clear();
+      }
+
+      if (verbose)
+        std::cout << "Entries: " << nnz
+                  << " full: " << full
+                  << (isDense_ ? " (dense)" : " (sparse)")
+                  << std::endl;
+    }
+    // y = C x for the first numRows rows of C, where x is a matrix
+    // with numBase rows of length n and y has numRows rows of length n;
+    // the coefficients of these rows in columns numBase and above must vanish
+    template< class XField >
+    void multMatrix ( const XField *x, unsigned int numBase, std::size_t n,
+                      unsigned int numRows, XField *y ) const
+    {
+      if( isDense_ )
+        dense_.multMatrix( x, numBase, n, numRows, y );
+      else
+        sparse_.multMatrix( x, numBase, n, numRows, y );
+    }
+    // b += a*C[k]
+    template <class Vector>
+    void addRow( unsigned int k, const Field &a, Vector &b) const
+    {
+      if( isDense_ )
+        dense_.addRow( k, a, b );
+      else
+        sparse_.addRow( k, a, b );
+    }
+
+  private:
+    AdaptiveCoeffMatrix ( const This &other );
+    This &operator= (const This&);
+
+    Sparse sparse_;
+    Dense dense_;
+    bool isDense_;
+  };
+
 }
 
 #endif // DUNE_COEFFMATRIX_HH
@@ -0,0 +1,227 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_LOCALFUNCTIONS_UTILITY_CONSTRUCTIONTHREADPOOL_HH
+#define DUNE_LOCALFUNCTIONS_UTILITY_CONSTRUCTIONTHREADPOOL_HH
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Dune
+{
+
+  /**
+   * \brief A pool of threads used while constructing the coefficients of
+   *        the generic local finite elements
+   *
+   * Filling and inverting the dense matrices of the generic bases is
+   * expensive for high orders, in particular with multi-precision compute
+   * fields. These loops are distributed over the threads of this pool.
+   * Each task writes its own part of the result and performs the same
+   * operations regardless of the thread executing it, so the results do
+   * not depend on the number of threads.
+   *
+   * The number of threads is taken from the environment variable
+   * DUNE_LOCALFUNCTIONS_NUM_THREADS or set by setNumThreads(), where 0
+   * selects the number of hardware threads. By default, everything runs
+   * in the calling thread. The worker threads are started on first use.
+   * The thread library is registered for all targets of modules using
+   * dune-localfunctions by DuneLocalfunctionsMacros.cmake.
+   *
+   * Only one loop runs on the pool at a time. A loop started while the
+   * pool is busy, e.g., from another thread constructing an element or
+   * from inside a task, is executed in the calling thread.
+   **/
+  class ConstructionThreadPool
+  {
+  public:
+    static ConstructionThreadPool &instance ()
+    {
+      static ConstructionThreadPool pool;
+      return pool;
+    }
+
+    ~ConstructionThreadPool ()
+    {
+      stop();
+    }
+
+    //! number of threads including the calling one
+    unsigned int numThreads () const
+    {
+      return numThreads_;
+    }
+
+    /** \brief set the number of threads, 0 selects the hardware concurrency
+     *
+     * Waits for a running loop to finish and stops the worker threads.
+     **/
+    void setNumThreads ( unsigned int numThreads )
+    {
+      std::lock_guard< std::mutex > jobGuard( jobMutex_ );
+      stop();
+      numThreads_ = normalize( numThreads );
+    }
+
+    /** \brief call f(i) for i = 0,...,numTasks-1
+     *
+     * The first exception thrown by a task is rethrown after all tasks
+     * have finished.
+     **/
+    template< class F >
+    void parallelFor ( std::size_t numTasks, F &&f )
+    {
+      if( (numThreads_ <= 1) || (numTasks <= 1) || insideJob() )
+      {
+        for( std::size_t i = 0; i < numTasks; ++i )
+          f( i );
+        return;
+      }
+
+      std::unique_lock< std::mutex > jobGuard( jobMutex_, std::try_to_lock );
+      if( !jobGuard )
+      {
+        for( std::size_t i = 0; i < numTasks; ++i )
+          f( i );
+        return;
+      }
+
+      start();
+      {
+        std::lock_guard< std::mutex > guard( mutex_ );
+        task_ = [ &f ] ( std::size_t i ) { f( i ); };
+        numTasks_ = numTasks;
+        next_ = 0;
+        busy_ = workers_.size();
+        error_ = nullptr;
+        ++generation_;
+      }
+      wakeUp_.notify_all();
+
+      insideJob() = true;
+      work();
+      insideJob() = false;
+
+      std::exception_ptr error;
+      {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        finished_.wait( lock, [ this ] () { return busy_ == 0; } );
+        task_ = nullptr;
+        std::swap( error, error_ );
+      }
+      if( error )
+        std::rethrow_exception( error );
+    }
+
+  private:
+    ConstructionThreadPool ()
+      : numThreads_( 1 ), generation_( 0 ), numTasks_( 0 ), busy_( 0 ), stop_( false )
+    {
+      const char *env = std::getenv( "DUNE_LOCALFUNCTIONS_NUM_THREADS" );
+      if( env )
+        numThreads_ = normalize( std::strtoul( env, nullptr, 10 ) );
+    }
+
+    ConstructionThreadPool ( const ConstructionThreadPool & ) = delete;
+    ConstructionThreadPool &operator= ( const ConstructionThreadPool & ) = delete;
+
+    static unsigned int normalize ( unsigned long numThreads )
+    {
+      if( numThreads == 0 )
+        numThreads = std::thread::hardware_concurrency();
+      return static_cast< unsigned int >( std::max( numThreads, 1ul ) );
+    }
+
+    static bool &insideJob ()
+    {
+      static thread_local bool inside = false;
+      return inside;
+    }
+
+    // execute tasks until none is left
+    void work ()
+    {
+      for( std::size_t i = next_++; i < numTasks_; i = next_++ )
+      {
+        try
+        {
+          task_( i );
+        }
+        catch( ... )
+        {
+          std::lock_guard< std::mutex > guard( mutex_ );
+          if( !error_ )
+            error_ = std::current_exception();
+        }
+      }
+    }
+
+    void run ( unsigned long generation )
+    {
+      insideJob() = true;
+      while( true )
+      {
+        {
+          std::unique_lock< std::mutex > lock( mutex_ );
+          wakeUp_.wait( lock, [ this, generation ] () { return stop_ || (generation_ != generation); } );
+          if( stop_ )
+            return;
+          generation = generation_;
+        }
+        work();
+        {
+          std::lock_guard< std::mutex > guard( mutex_ );
+          --busy_;
+        }
+        finished_.notify_one();
+      }
+    }
+
+    void start ()
+    {
+      if( workers_.empty() )
+        stop_ = false;
+      while( workers_.size() + 1 < numThreads_ )
+        workers_.emplace_back( [ this, generation = generation_ ] () { run( generation ); } );
+    }
+
+    void stop ()
+    {
+      {
+        std::lock_guard< std::mutex > guard( mutex_ );
+        stop_ = true;
+      }
+      wakeUp_.notify_all();
+      for( std::thread &worker : workers_ )
+        worker.join();
+      workers_.clear();
+    }
+
+    std::atomic< unsigned int > numThreads_;
+    std::vector< std::thread > workers_;
+
+    // held while a loop runs on the pool
+    std::mutex jobMutex_;
+
+    // protects the state of the current loop
+    std::mutex mutex_;
+    std::condition_variable wakeUp_, finished_;
+    unsigned long generation_;
+    std::function< void ( std::size_t ) > task_;
+    std::size_t numTasks_;
+    std::atomic< std::size_t > next_;
+    std::size_t busy_;
+    std::exception_ptr error_;
+    bool stop_;
+  };
+
+}
+
+#endif // #ifndef DUNE_LOCALFUNCTIONS_UTILITY_CONSTRUCTIONTHREADPOOL_HH
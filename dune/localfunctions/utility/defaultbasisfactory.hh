@@ -7,6 +7,7 @@
 #include <dune/common/exceptions.hh>
 #include <dune/geometry/topologyfactory.hh>
 
+#include <dune/localfunctions/utility/basiscoefficientcache.hh>
 #include <dune/localfunctions/utility/basismatrix.hh>
 
 namespace Dune
@@ -27,6 +28,9 @@ namespace Dune
   * The user provides factories for the pre basis and the
   * interpolations. The default construction process of
   * the basis is performed in this class.
+  * If a BasisCoefficientCache directory is set, the
+  * coefficient matrix is loaded from there instead of
+  * being recomputed.
   ************************************************/
   template< class PreBFactory,
       class InterpolFactory,
@@ -53,7 +57,7 @@ namespace Dune
     typedef typename PreBasisFactory::template EvaluationBasisFactory<dim,SF>::Type MonomialBasisFactory;
     typedef typename MonomialBasisFactory::Object MonomialBasis;
     typedef StandardEvaluator< MonomialBasis > Evaluator;
-    typedef PolynomialBasisWithMatrix< Evaluator, SparseCoeffMatrix< SF, dimRange > > Basis;
+    typedef PolynomialBasisWithMatrix< Evaluator, AdaptiveCoeffMatrix< SF, dimRange > > Basis;
 
     typedef const Basis Object;
     typedef typename InterpolationFactory::Key Key;
@@ -80,6 +84,11 @@ namespace Dune
 
     typedef typename Traits::Object Object;
     typedef typename Traits::Key Key;
+    typedef typename Traits::Factory Factory;
+
+    //! revision of the coefficient computation, see BasisCoefficientCache
+    static const unsigned int coefficientRevision = 1;
+
     template <unsigned int dd, class FF>
     struct EvaluationBasisFactory
     {
@@ -92,18 +101,34 @@ namespace Dune
     {
       const typename PreBasisFactory::Key preBasisKey = PreBasisKeyExtractor::apply(key);
       const typename Traits::PreBasis *preBasis = Traits::PreBasisFactory::template create<Topology>( preBasisKey );
-      const typename Traits::Interpolation *interpol = Traits::InterpolationFactory::template create<Topology>( key );
-      BasisMatrix< typename Traits::PreBasis,
-          typename Traits::Interpolation,
-          ComputeField > matrix( *preBasis, *interpol );
 
       const typename Traits::MonomialBasis *monomialBasis = Traits::MonomialBasisFactory::template create< Topology >( preBasis->order() );
 
       Basis *basis = new Basis( *monomialBasis );
 
-      basis->fill( matrix );
+      const std::string cacheKey = BasisCoefficientCache::key< Factory, Key, StorageField, ComputeField >( Topology::id, dimension, key );
+      StoredBasisMatrix< StorageField > storedMatrix;
+      if( BasisCoefficientCache::load( cacheKey, storedMatrix ) )
+        basis->fill( storedMatrix );
+      else
+      {
+        const typename Traits::Interpolation *interpol = Traits::InterpolationFactory::template create<Topology>( key );
+        BasisMatrix< typename Traits::PreBasis,
+            typename Traits::Interpolation,
+            ComputeField > matrix( *preBasis, *interpol );
+
+        if( BasisCoefficientCache::enabled() && !cacheKey.empty() )
+        {
+          storedMatrix = StoredBasisMatrix< StorageField >( matrix );
+          BasisCoefficientCache::store( cacheKey, storedMatrix );
+          basis->fill( storedMatrix );
+        }
+        else
+          basis->fill( matrix );
+
+        Traits::InterpolationFactory::release(interpol);
+      }
 
-      Traits::InterpolationFactory::release(interpol);
       Traits::PreBasisFactory::release(preBasis);
 
       return basis;
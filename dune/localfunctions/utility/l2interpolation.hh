@@ -3,6 +3,20 @@
 #ifndef DUNE_L2INTERPOLATION_HH
 #define DUNE_L2INTERPOLATION_HH
 
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/geometry/quadraturerules.hh>
 
@@ -39,6 +53,12 @@ namespace Dune
 
     static const unsigned int dimension = Basis::dimension;
 
+    /** \brief compute the coefficients of the interpolation of a function
+     *
+     *  This is one product of the precomputed, weighted basis values with
+     *  the function values at the quadrature points. It does not allocate
+     *  memory apart from resizing the coefficients and is reentrant.
+     */
     template< class Function, class DofField >
     void interpolate ( const Function &function, std::vector< DofField > &coefficients ) const
     {
@@ -46,23 +66,20 @@ namespace Dune
       typedef FieldVector< DofField, Basis::dimRange > RangeVector;
 
       const unsigned int size = basis().size();
-      static std::vector< RangeVector > basisValues( size );
-
       coefficients.resize( size );
-      basisValues.resize( size );
       for( unsigned int i = 0; i < size; ++i )
         coefficients[ i ] = Zero< DofField >();
 
       const Iterator end = quadrature().end();
-      for( Iterator it = quadrature().begin(); it != end; ++it )
+      typename WeightedValues::const_iterator weighted = weightedValues_->begin();
+      for( Iterator it = quadrature().begin(); it != end; ++it, weighted += size )
       {
-        basis().evaluate( it->position(), basisValues );
         typename Function::RangeType val;
         function.evaluate( field_cast<typename Function::DomainType::field_type>(it->position()), val );
-        RangeVector factor = field_cast< DofField >( val );
-        factor *= field_cast< DofField >( it->weight() );
+        const RangeVector factor = field_cast< DofField >( val );
         for( unsigned int i = 0; i < size; ++i )
-          coefficients[ i ] += factor * basisValues[ i ];
+          for( unsigned int r = 0; r < Basis::dimRange; ++r )
+            coefficients[ i ] += factor[ r ] * field_cast< DofField >( weighted[ i ][ r ] );
       }
     }
 
@@ -76,14 +93,54 @@ namespace Dune
       return quadrature_;
     }
 
+    //! true if both interpolations use the same precomputed projection
+    bool sharesProjection ( const This &other ) const
+    {
+      return weightedValues_ == other.weightedValues_;
+    }
+
   protected:
-    LocalL2InterpolationBase ( const Basis &basis, const Quadrature &quadrature )
+    typedef typename Basis::StorageField Field;
+    typedef FieldVector< Field, Basis::dimRange > WeightedValue;
+    typedef std::vector< WeightedValue > WeightedValues;
+
+    LocalL2InterpolationBase ( const Basis &basis, const Quadrature &quadrature,
+                               std::shared_ptr< const WeightedValues > weightedValues )
       : basis_( basis ),
-        quadrature_( quadrature )
-    {}
+        quadrature_( quadrature ),
+        weightedValues_( std::move( weightedValues ) )
+    {
+      assert( weightedValues_->size() == quadrature.size()*basis.size() );
+    }
+
+    // basis values at the quadrature points multiplied by the weights,
+    // the values for point q start at q*basis.size()
+    static std::shared_ptr< WeightedValues >
+    weightedValues ( const Basis &basis, const Quadrature &quadrature )
+    {
+      typedef typename Quadrature::iterator Iterator;
+      const unsigned int size = basis.size();
+      std::vector< WeightedValue > basisValues( size );
+
+      std::shared_ptr< WeightedValues > weighted = std::make_shared< WeightedValues >();
+      weighted->reserve( quadrature.size()*size );
+      const Iterator end = quadrature.end();
+      for( Iterator it = quadrature.begin(); it != end; ++it )
+      {
+        basis.evaluate( it->position(), basisValues );
+        for( unsigned int i = 0; i < size; ++i )
+        {
+          WeightedValue value = basisValues[ i ];
+          value *= field_cast< Field >( it->weight() );
+          weighted->push_back( value );
+        }
+      }
+      return weighted;
+    }
 
     const Basis &basis_;
     const Quadrature &quadrature_;
+    std::shared_ptr< const WeightedValues > weightedValues_;
   };
 
   template< class B, class Q >
@@ -96,8 +153,21 @@ namespace Dune
     using typename Base::Basis;
     using typename Base::Quadrature;
   private:
+    typedef typename Base::WeightedValues WeightedValues;
+
+    // for an orthonormal basis the mass matrix is the identity
+    static std::shared_ptr< const WeightedValues >
+    projection ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
+    {
+      return Base::weightedValues( basis, quadrature );
+    }
+
     LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
-      : Base(basis,quadrature)
+      : Base(basis,quadrature,projection(basis,quadrature))
+    {}
+    LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature,
+                           std::shared_ptr< const WeightedValues > weightedValues )
+      : Base(basis,quadrature,std::move(weightedValues))
     {}
   };
   template< class B, class Q >
@@ -109,55 +179,62 @@ namespace Dune
     friend class LocalL2InterpolationFactory;
     using typename Base::Basis;
     using typename Base::Quadrature;
-    template< class Function, class DofField >
-    void interpolate ( const Function &function, std::vector< DofField > &coefficients ) const
-    {
-      const unsigned size = Base::basis().size();
-      Base::interpolate(function,val_);
-      coefficients.resize( size );
-      for (unsigned int i=0; i<size; ++i)
-      {
-        coefficients[i] = 0;
-        for (unsigned int j=0; j<size; ++j)
-        {
-          coefficients[i] += field_cast<DofField>(massMatrix_(i,j)*val_[j]);
-        }
-      }
-    }
   private:
-    LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
-      : Base(basis,quadrature),
-        val_(basis.size()),
-        massMatrix_()
+    typedef typename Base::Field Field;
+    typedef typename Base::WeightedValue WeightedValue;
+    typedef typename Base::WeightedValues WeightedValues;
+    typedef LFEMatrix<Field> MassMatrix;
+
+    // The weighted basis values are multiplied by the inverse mass matrix
+    // once, using its Cholesky factorization, so that the interpolation is
+    // the same product as for an orthonormal basis.
+    static std::shared_ptr< const WeightedValues >
+    projection ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
     {
-      typedef FieldVector< Field, Base::Basis::dimRange > RangeVector;
       typedef typename Base::Quadrature::iterator Iterator;
       const unsigned size = basis.size();
-      std::vector< RangeVector > basisValues( size );
+      std::vector< WeightedValue > basisValues( size );
 
-      massMatrix_.resize( size,size );
+      MassMatrix massMatrix;
+      massMatrix.resize( size,size );
       for (unsigned int i=0; i<size; ++i)
-        for (unsigned int j=0; j<size; ++j)
-          massMatrix_(i,j) = 0;
-      const Iterator end = Base::quadrature().end();
-      for( Iterator it = Base::quadrature().begin(); it != end; ++it )
+        for (unsigned int j=0; j<=i; ++j)
+          massMatrix(i,j) = 0;
+      const Iterator end = quadrature.end();
+      for( Iterator it = quadrature.begin(); it != end; ++it )
       {
-        Base::basis().evaluate( it->position(), basisValues );
+        basis.evaluate( it->position(), basisValues );
         for (unsigned int i=0; i<size; ++i)
-          for (unsigned int j=0; j<size; ++j)
-            massMatrix_(i,j) += (basisValues[i]*basisValues[j])*it->weight();
+          for (unsigned int j=0; j<=i; ++j)
+            massMatrix(i,j) += (basisValues[i]*basisValues[j])*it->weight();
       }
-      if ( !massMatrix_.invert() )
+      LFECholesky<Field> cholesky;
+      if ( !cholesky.factorize( massMatrix ) )
       {
         DUNE_THROW(MathError, "Mass matrix singular in LocalL2Interpolation");
       }
 
+      std::shared_ptr< WeightedValues > weighted = Base::weightedValues( basis, quadrature );
+      std::vector< Field > rhs( size );
+      for( std::size_t q = 0; q < weighted->size(); q += size )
+        for (unsigned int r=0; r<Base::Basis::dimRange; ++r)
+        {
+          for (unsigned int i=0; i<size; ++i)
+            rhs[i] = (*weighted)[q+i][r];
+          cholesky.solve( rhs );
+          for (unsigned int i=0; i<size; ++i)
+            (*weighted)[q+i][r] = rhs[i];
+        }
+      return weighted;
     }
-    typedef typename Base::Basis::StorageField Field;
-    typedef FieldVector< Field, Base::Basis::dimRange > RangeVector;
-    typedef LFEMatrix<Field> MassMatrix;
-    mutable std::vector<Field> val_;
-    MassMatrix massMatrix_;
+
+    LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature )
+      : Base(basis,quadrature,projection(basis,quadrature))
+    {}
+    LocalL2Interpolation ( const typename Base::Basis &basis, const typename Base::Quadrature &quadrature,
+                           std::shared_ptr< const WeightedValues > weightedValues )
+      : Base(basis,quadrature,std::move(weightedValues))
+    {}
   };
 
   /**
@@ -200,7 +277,8 @@ namespace Dune
       Dune::GeometryType gt(Topology::id, Topology::dimension);
       const Basis *basis = BasisFactory::template create< Topology >( key );
       const Quadrature & quadrature = Traits::QuadratureProvider::rule(gt, 2*basis->order()+1);
-      return new Object( *basis, quadrature );
+      return new Object( *basis, quadrature,
+                         projection( Topology::id, key, *basis, quadrature, std::is_arithmetic< Key >() ) );
     }
     static void release ( Object *object )
     {
@@ -208,6 +286,59 @@ namespace Dune
       BasisFactory::release( &basis );
       delete object;
     }
+
+  private:
+    typedef typename Traits::LocalInterpolation::WeightedValues WeightedValues;
+
+    struct ProjectionEntry
+    {
+      std::once_flag computed;
+      std::shared_ptr< const WeightedValues > weightedValues;
+    };
+
+    // The projection only depends on the basis factory, the topology, the key,
+    // and the quadrature, so it is shared between all interpolations alive at
+    // the same time. This requires a comparable key. Only the lookup of the
+    // entry is serialized, the projection is computed outside the lock.
+    static std::shared_ptr< const WeightedValues >
+    projection ( unsigned int topologyId, const Key &key, const Basis &basis, const Quadrature &quadrature,
+                 std::true_type )
+    {
+      typedef std::tuple< unsigned int, Key, const Quadrature * > ProjectionKey;
+      static std::mutex mutex;
+      static std::map< ProjectionKey, std::weak_ptr< ProjectionEntry > > projections;
+
+      const ProjectionKey projectionKey( topologyId, key, &quadrature );
+      std::shared_ptr< ProjectionEntry > entry;
+      {
+        std::lock_guard< std::mutex > guard( mutex );
+        std::weak_ptr< ProjectionEntry > &slot = projections[ projectionKey ];
+        entry = slot.lock();
+        if( !entry )
+        {
+          entry = std::make_shared< ProjectionEntry >();
+          slot = entry;
+          // drop the entries of projections no longer in use, so the registry
+          // only grows with the number of projections alive at the same time
+          for( auto it = projections.begin(); it != projections.end(); )
+            it = (it->second.expired() ? projections.erase( it ) : std::next( it ));
+        }
+      }
+
+      ProjectionEntry *const e = entry.get();
+      std::call_once( e->computed, [ e, &basis, &quadrature ] () {
+          e->weightedValues = Traits::LocalInterpolation::projection( basis, quadrature );
+        } );
+      // the returned pointer keeps the entry alive
+      return std::shared_ptr< const WeightedValues >( std::move( entry ), e->weightedValues.get() );
+    }
+
+    static std::shared_ptr< const WeightedValues >
+    projection ( unsigned int topologyId, const Key &key, const Basis &basis, const Quadrature &quadrature,
+                 std::false_type )
+    {
+      return Traits::LocalInterpolation::projection( basis, quadrature );
+    }
   };
 
 }
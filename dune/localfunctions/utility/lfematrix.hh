@@ -3,54 +3,67 @@
 #ifndef DUNE_LOCALFUNCTIONS_UTILITY_LFEMATRIX_HH
 #define DUNE_LOCALFUNCTIONS_UTILITY_LFEMATRIX_HH
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
+#include "constructionthreadpool.hh"
 #include "field.hh"
 
 namespace Dune
 {
 
+  /**
+   * \brief A dense matrix used while constructing the generic local
+   *        finite elements
+   *
+   * The entries are stored row-wise in one contiguous array, so rowPtr(i)
+   * points to cols() consecutive entries and rowPtr(i+1) follows directly.
+   * The inversion uses a blocked LU factorization with partial pivoting,
+   * such that the trailing updates work on blocks of rows that stay in
+   * cache also for the large matrices of high order bases. The updates of
+   * independent rows are distributed over the ConstructionThreadPool; the
+   * result does not depend on the number of threads.
+   **/
   template< class F >
   class LFEMatrix
   {
     typedef LFEMatrix< F > This;
     typedef std::vector< F > Row;
-    typedef std::vector<Row> RealMatrix;
 
   public:
     typedef F Field;
 
-    operator const RealMatrix & () const
-    {
-      return matrix_;
-    }
+    //! number of columns of the panels of the blocked algorithms
+    static const unsigned int blockSize = 32;
 
-    operator RealMatrix & ()
-    {
-      return matrix_;
-    }
+    LFEMatrix ()
+      : cols_( 0 ), rows_( 0 )
+    {}
 
     template <class Vector>
     void row( const unsigned int row, Vector &vec ) const
     {
       assert(row<rows());
-      for (int i=0; i<cols(); ++i)
-        field_cast(matrix_[row][i], vec[i]);
+      const Field *r = rowPtr(row);
+      for (unsigned int i=0; i<cols(); ++i)
+        field_cast(r[i], vec[i]);
     }
 
     const Field &operator() ( const unsigned int row, const unsigned int col ) const
     {
       assert(row<rows());
       assert(col<cols());
-      return matrix_[ row ][ col ];
+      return matrix_[ row*cols_ + col ];
     }
 
     Field &operator() ( const unsigned int row, const unsigned int col )
     {
       assert(row<rows());
       assert(col<cols());
-      return matrix_[ row ][ col ];
+      return matrix_[ row*cols_ + col ];
     }
 
     unsigned int rows () const
@@ -66,85 +79,359 @@ namespace Dune
     const Field *rowPtr ( const unsigned int row ) const
     {
       assert(row<rows());
-      return &(matrix_[row][0]);
+      return matrix_.data() + row*cols_;
     }
 
     Field *rowPtr ( const unsigned int row )
     {
       assert(row<rows());
-      return &(matrix_[row][0]);
+      return matrix_.data() + row*cols_;
     }
 
+    //! resize the matrix, entries in the common part keep their values
     void resize ( const unsigned int rows, const unsigned int cols )
     {
-      matrix_.resize(rows);
-      for (unsigned int i=0; i<rows; ++i)
-        matrix_[i].resize(cols);
+      if (cols == cols_ || rows_ == 0)
+        matrix_.resize( rows*cols, Zero<Field>() );
+      else
+      {
+        std::vector< Field > matrix( rows*cols, Zero<Field>() );
+        const unsigned int commonRows = std::min( rows, rows_ );
+        const unsigned int commonCols = std::min( cols, cols_ );
+        for (unsigned int i=0; i<commonRows; ++i)
+          std::copy( rowPtr(i), rowPtr(i)+commonCols, matrix.begin() + i*cols );
+        matrix_.swap( matrix );
+      }
       rows_ = rows;
       cols_ = cols;
     }
 
-    bool invert ()
+    /** \brief LU factorization with partial pivoting, PA = LU
+     *
+     *  The matrix is overwritten by U and the strictly lower part of the
+     *  unit lower triangular L. Row i was interchanged with row pivot[i]
+     *  in step i.
+     *
+     *  \returns false if the matrix is singular
+     **/
+    bool luDecompose ( std::vector< unsigned int > &pivot )
     {
       assert( rows() == cols() );
-      std::vector<unsigned int> p(rows());
-      for (unsigned int j=0; j<rows(); ++j)
-        p[j] = j;
-      for (unsigned int j=0; j<rows(); ++j)
+      const unsigned int n = rows();
+      pivot.resize( n );
+      for (unsigned int j0=0; j0<n; j0+=blockSize)
       {
-        // pivot search
-        unsigned int r = j;
-        Field max = std::abs( (*this)(j,j) );
-        for (unsigned int i=j+1; i<rows(); ++i)
+        const unsigned int j1 = std::min( j0+blockSize, n );
+
+        // factorize the panel of columns j0,...,j1-1, the row interchanges
+        // are applied to the whole rows
+        for (unsigned int j=j0; j<j1; ++j)
         {
-          if ( std::abs( (*this)(i,j) ) > max )
+          unsigned int r = j;
+          Field max = std::abs( (*this)(j,j) );
+          for (unsigned int i=j+1; i<n; ++i)
+          {
+            if ( std::abs( (*this)(i,j) ) > max )
+            {
+              max = std::abs( (*this)(i,j) );
+              r = i;
+            }
+          }
+          if (max == Zero<Field>())
+            return false;
+          pivot[j] = r;
+          if (r > j)
+            std::swap_ranges( rowPtr(j), rowPtr(j)+n, rowPtr(r) );
+
+          const Field hr = Unity<Field>()/(*this)(j,j);
+          const Field *uj = rowPtr(j);
+          for (unsigned int i=j+1; i<n; ++i)
           {
-            max = std::abs( (*this)(i,j) );
-            r = i;
+            Field *ai = rowPtr(i);
+            ai[j] *= hr;
+            const Field lij = ai[j];
+            for (unsigned int k=j+1; k<j1; ++k)
+              ai[k] -= lij*uj[k];
           }
         }
-        if (max == Zero<Field>())
-          return false;
-        // row swap
-        if (r > j)
+
+        if (j1 == n)
+          break;
+
+        // rows j0,...,j1-1 of U right of the panel: U12 = L11^{-1} A12
+        forEachRange( j1, n, 8*blockSize, [ this, j0, j1 ] ( unsigned int c0, unsigned int c1 ) {
+            for (unsigned int i=j0+1; i<j1; ++i)
+            {
+              Field *ai = rowPtr(i);
+              for (unsigned int k=j0; k<i; ++k)
+                axpy( -ai[k], rowPtr(k)+c0, ai+c0, c1-c0 );
+            }
+          } );
+
+        // trailing update A22 -= L21 U12 for blocks of rows, in column
+        // blocks to keep the rows of U12 in cache
+        forEachRange( j1, n, tileSize, [ this, n, j0, j1 ] ( unsigned int i0, unsigned int i1 ) {
+            for (unsigned int c0=j1; c0<n; c0+=8*blockSize)
+            {
+              const unsigned int c1 = std::min( c0+8*blockSize, n );
+              for (unsigned int i=i0; i<i1; ++i)
+              {
+                Field *ai = rowPtr(i);
+                for (unsigned int k=j0; k<j1; ++k)
+                  axpy( -ai[k], rowPtr(k)+c0, ai+c0, c1-c0 );
+              }
+            }
+          } );
+      }
+      return true;
+    }
+
+    /** \brief solve Ax = b with the result of luDecompose
+     *
+     *  The right hand side is overwritten by the solution.
+     **/
+    template< class Vector >
+    void luSolve ( const std::vector< unsigned int > &pivot, Vector &x ) const
+    {
+      const unsigned int n = rows();
+      assert( pivot.size() == n && x.size() >= n );
+      for (unsigned int i=0; i<n; ++i)
+        if (pivot[i] != i)
+          std::swap( x[i], x[pivot[i]] );
+      for (unsigned int i=1; i<n; ++i)
+      {
+        const Field *ai = rowPtr(i);
+        for (unsigned int k=0; k<i; ++k)
+          x[i] -= ai[k]*x[k];
+      }
+      for (unsigned int i=n; i-- > 0; )
+      {
+        const Field *ai = rowPtr(i);
+        for (unsigned int k=i+1; k<n; ++k)
+          x[i] -= ai[k]*x[k];
+        x[i] /= ai[i];
+      }
+    }
+
+    /** \brief replace the matrix by its inverse
+     *
+     *  Computes A^{-1} = U^{-1} L^{-1} P from the LU factorization.
+     *
+     *  \returns false if the matrix is singular
+     **/
+    bool invert ()
+    {
+      assert( rows() == cols() );
+      const unsigned int n = rows();
+      std::vector< unsigned int > pivot;
+      if (!luDecompose( pivot ))
+        return false;
+
+      // U^{-1}, each row i solves x U = e_i independently of the others and
+      // only reads the rows k >= i of U. So the rows are computed from top
+      // to bottom in bands of one tile per thread, and a band is written
+      // back once it is complete; the buffer holds one band instead of a
+      // second n x n matrix.
+      {
+        const unsigned int bandSize = tileSize * std::max( ConstructionThreadPool::instance().numThreads(), 1u );
+        Row band;
+        for (unsigned int b0=0; b0<n; b0+=bandSize)
         {
-          for (unsigned int k=0; k<cols(); ++k)
-            std::swap( (*this)(j,k), (*this)(r,k) );
-          std::swap( p[j], p[r] );
+          const unsigned int b1 = std::min( b0+bandSize, n );
+          band.assign( (b1-b0)*n, Zero<Field>() );
+          forEachRange( b0, b1, tileSize, [ this, n, b0, &band ] ( unsigned int i0, unsigned int i1 ) {
+              for (unsigned int i=i0; i<i1; ++i)
+                band[ (i-b0)*n + i ] = Unity<Field>();
+              for (unsigned int k=i0; k<n; ++k)
+              {
+                const Field *uk = rowPtr(k);
+                for (unsigned int i=i0; i<std::min( i1, k+1 ); ++i)
+                {
+                  Field *xi = band.data() + (i-b0)*n;
+                  xi[k] /= uk[k];
+                  axpy( -xi[k], uk+k+1, xi+k+1, n-k-1 );
+                }
+              }
+            } );
+          for (unsigned int i=b0; i<b1; ++i)
+            std::copy( band.begin() + (i-b0)*n + i, band.begin() + (i-b0+1)*n, rowPtr(i) + i );
         }
-        // transformation
-        Field hr = Unity<Field>()/(*this)(j,j);
-        for (unsigned int i=0; i<rows(); ++i)
-          (*this)(i,j) *= hr;
-        (*this)(j,j) = hr;
-        for (unsigned int k=0; k<cols(); ++k)
+      }
+
+      // solve X L = U^{-1} for blocks of columns from right to left; the
+      // strictly lower part of the matrix still holds L
+      Row w;
+      for (unsigned int j1=n; j1>0; )
+      {
+        const unsigned int j0 = (j1 > blockSize ? j1-blockSize : 0);
+        const unsigned int nb = j1-j0;
+        // move the columns j0,...,j1-1 of L into w, row k of w holds L(k,j0:j1)
+        w.assign( (n-j0)*nb, Zero<Field>() );
+        for (unsigned int k=j0+1; k<n; ++k)
         {
-          if (k==j) continue;
-          for (unsigned int i=0; i<rows(); ++i)
+          Field *ak = rowPtr(k);
+          for (unsigned int j=j0; j<std::min( k, j1 ); ++j)
           {
-            if (i==j) continue;
-            (*this)(i,k) -= (*this)(i,j)*(*this)(j,k);
+            w[ (k-j0)*nb + (j-j0) ] = ak[j];
+            ak[j] = Zero<Field>();
           }
-          (*this)(j,k) *= -hr;
         }
+        forEachRange( 0, n, tileSize, [ this, n, j0, j1, nb, &w ] ( unsigned int i0, unsigned int i1 ) {
+            for (unsigned int i=i0; i<i1; ++i)
+            {
+              Field *ai = rowPtr(i);
+              // contribution of the columns right of the block
+              for (unsigned int k=j1; k<n; ++k)
+                axpy( -ai[k], w.data() + (k-j0)*nb, ai+j0, nb );
+              // triangular solve within the block
+              for (unsigned int k=j1; k-- > j0+1; )
+                axpy( -ai[k], w.data() + (k-j0)*nb, ai+j0, k-j0 );
+            }
+          } );
+        j1 = j0;
       }
-      // column exchange
-      Row hv(rows());
-      for (unsigned int i=0; i<rows(); ++i)
+
+      // column interchanges in reverse order
+      for (unsigned int j=n; j-- > 0; )
       {
-        for (unsigned int k=0; k<rows(); ++k)
-          hv[ p[k] ] = (*this)(i,k);
-        for (unsigned int k=0; k<rows(); ++k)
-          (*this)(i,k) = hv[k];
+        if (pivot[j] == j)
+          continue;
+        for (unsigned int i=0; i<n; ++i)
+        {
+          Field *ai = rowPtr(i);
+          std::swap( ai[j], ai[pivot[j]] );
+        }
       }
       return true;
     }
 
   private:
-    RealMatrix matrix_;
+    // number of rows treated by one task of the parallel loops
+    static const unsigned int tileSize = 16;
+
+    // call f(first,last) for consecutive ranges of at most chunk indices
+    // covering [begin,end), distributed over the ConstructionThreadPool
+    template< class Function >
+    static void forEachRange ( unsigned int begin, unsigned int end, unsigned int chunk, Function f )
+    {
+      const std::size_t numRanges = (end > begin ? (end - begin + chunk - 1) / chunk : 0);
+      ConstructionThreadPool::instance().parallelFor( numRanges, [ & ] ( std::size_t r ) {
+          const unsigned int first = begin + r*chunk;
+          f( first, std::min( first + chunk, end ) );
+        } );
+    }
+
+    // y += a x, skipped for vanishing a
+    static void axpy ( const Field &a, const Field *x, Field *y, unsigned int n )
+    {
+      if (a == Field( 0 ))
+        return;
+      for (unsigned int k=0; k<n; ++k)
+        y[k] += a*x[k];
+    }
+
+    std::vector< Field > matrix_;
     unsigned int cols_,rows_;
   };
 
+  /**
+   * \brief Cholesky factorization M = L L^T of a symmetric positive
+   *        definite LFEMatrix
+   *
+   * The lower triangle L is stored row-wise in one contiguous array.
+   * Solving with the factorization is more accurate than multiplying by
+   * the explicitly inverted matrix and needs no pivoting.
+   **/
+  template< class F >
+  class LFECholesky
+  {
+  public:
+    typedef F Field;
+
+    LFECholesky ()
+      : size_( 0 )
+    {}
+
+    /** \brief factorize a symmetric matrix, only the lower triangle is used
+     *
+     *  \returns false if the matrix is not positive definite
+     **/
+    bool factorize ( const LFEMatrix< Field > &matrix )
+    {
+      using std::sqrt;
+      assert( matrix.rows() == matrix.cols() );
+      size_ = matrix.rows();
+      lower_.assign( size_*(size_+1)/2, Zero< Field >() );
+      for( unsigned int i = 0; i < size_; ++i )
+      {
+        Field *li = row( i );
+        for( unsigned int j = 0; j <= i; ++j )
+        {
+          const Field *lj = row( j );
+          Field sum = matrix( i, j );
+          for( unsigned int k = 0; k < j; ++k )
+            sum -= li[ k ]*lj[ k ];
+          if( j < i )
+            li[ j ] = sum / lj[ j ];
+          else if( Zero< Field >() < sum )
+            li[ i ] = sqrt( sum );
+          else
+            return false;
+        }
+      }
+      return true;
+    }
+
+    unsigned int size () const
+    {
+      return size_;
+    }
+
+    //! entry (i,j) of the lower triangular factor L
+    Field lower ( unsigned int i, unsigned int j ) const
+    {
+      assert( (i < size_) && (j < size_) );
+      return (j <= i ? row( i )[ j ] : Zero< Field >());
+    }
+
+    //! solve L L^T x = b, the right hand side is overwritten by the solution
+    template< class Vector >
+    void solve ( Vector &x ) const
+    {
+      assert( x.size() >= size_ );
+      // forward substitution with L
+      for( unsigned int i = 0; i < size_; ++i )
+      {
+        const Field *li = row( i );
+        Field sum = x[ i ];
+        for( unsigned int k = 0; k < i; ++k )
+          sum -= li[ k ]*x[ k ];
+        x[ i ] = sum / li[ i ];
+      }
+      // backward substitution with L^T
+      for( unsigned int i = size_; i-- > 0; )
+      {
+        Field sum = x[ i ];
+        for( unsigned int k = i+1; k < size_; ++k )
+          sum -= row( k )[ i ]*x[ k ];
+        x[ i ] = sum / row( i )[ i ];
+      }
+    }
+
+  private:
+    const Field *row ( unsigned int i ) const
+    {
+      return lower_.data() + i*(i+1)/2;
+    }
+    Field *row ( unsigned int i )
+    {
+      return lower_.data() + i*(i+1)/2;
+    }
+
+    unsigned int size_;
+    std::vector< Field > lower_;
+  };
+
   template< class Field >
   inline std::ostream &operator<<(std::ostream &out, const LFEMatrix<Field> &mat)
   {
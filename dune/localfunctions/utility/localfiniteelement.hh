@@ -3,6 +3,8 @@
 #ifndef DUNE_GENERIC_LOCALFINITEELEMENT_HH
 #define DUNE_GENERIC_LOCALFINITEELEMENT_HH
 
+#include <memory>
+
 #include <dune/geometry/type.hh>
 
 #include <dune/localfunctions/common/localfiniteelementtraits.hh>
@@ -46,19 +48,12 @@ namespace Dune
       Impl::IfTopology< FiniteElement::template Maker, dimDomain >::apply( topologyId_, key_, finiteElement_ );
     }
 
-    /** \todo Please doc me */
-    GenericLocalFiniteElement ( const GenericLocalFiniteElement &other )
-      : topologyId_( other.topologyId_ ),
-        key_( other.key_ ),
-        finiteElement_()
-    {
-      Impl::IfTopology< FiniteElement::template Maker, dimDomain >::apply( topologyId_, key_, finiteElement_ );
-    }
-
-    ~GenericLocalFiniteElement()
-    {
-      finiteElement_.release();
-    }
+    /** \brief copy constructor
+     *
+     *  The basis, coefficients, and interpolation are immutable and shared
+     *  with the copied element, so copying does not call the factories.
+     */
+    GenericLocalFiniteElement ( const GenericLocalFiniteElement &other ) = default;
 
     /** \todo Please doc me !
      */
@@ -103,26 +98,27 @@ namespace Dune
   private:
     struct FiniteElement
     {
-      FiniteElement() : basis_(0), coeff_(0), interpol_(0) {}
       template <class Topology>
       void create( const Key &key )
       {
-        release();
-        basis_ = BasisF::template create<Topology>(key);
-        coeff_ = CoeffF::template create<Topology>(key);
-        interpol_ = InterpolF::template create<Topology>(key);
+        basis_ = makeShared< BasisF >( BasisF::template create<Topology>(key) );
+        coeff_ = makeShared< CoeffF >( CoeffF::template create<Topology>(key) );
+        interpol_ = makeShared< InterpolF >( InterpolF::template create<Topology>(key) );
       }
-      void release()
+      // returns the object to its factory when the last element using it is destroyed
+      template< class Factory >
+      struct Release
+      {
+        void operator() ( typename Factory::Object *object ) const
+        {
+          if (object)
+            Factory::release(object);
+        }
+      };
+      template< class Factory >
+      static std::shared_ptr< typename Factory::Object > makeShared ( typename Factory::Object *object )
       {
-        if (basis_)
-          BasisF::release(basis_);
-        if (coeff_)
-          CoeffF::release(coeff_);
-        if (interpol_)
-          InterpolF::release(interpol_);
-        basis_=0;
-        coeff_=0;
-        interpol_=0;
+        return std::shared_ptr< typename Factory::Object >( object, Release< Factory >() );
       }
       template< class Topology >
       struct Maker
@@ -132,9 +128,9 @@ namespace Dune
           finiteElement.template create<Topology>(key);
         };
       };
-      typename Traits::LocalBasisType *basis_;
-      typename Traits::LocalCoefficientsType *coeff_;
-      typename Traits::LocalInterpolationType *interpol_;
+      std::shared_ptr< typename Traits::LocalBasisType > basis_;
+      std::shared_ptr< typename Traits::LocalCoefficientsType > coeff_;
+      std::shared_ptr< typename Traits::LocalInterpolationType > interpol_;
     };
     unsigned int topologyId_;
     Key key_;
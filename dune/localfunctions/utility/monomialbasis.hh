@@ -3,14 +3,25 @@
 #ifndef DUNE_MONOMIALBASIS_HH
 #define DUNE_MONOMIALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
 #include <dune/geometry/topologyfactory.hh>
 #include <dune/geometry/type.hh>
 
+#include <dune/localfunctions/common/localbasis.hh>
 #include <dune/localfunctions/utility/field.hh>
 #include <dune/localfunctions/utility/multiindex.hh>
 #include <dune/localfunctions/utility/tensor.hh>
@@ -72,11 +83,28 @@ namespace Dune
   template< class Topology, class F >
   class MonomialBasis;
 
+  /** \brief highest order of the size tables of the monomial bases
+   *
+   *  In high dimensions, the tables end earlier, at the last order whose
+   *  number of basis functions fits into an unsigned int, see
+   *  MonomialBasisSize::maxOrder(). Higher orders raise a RangeError.
+   */
+  static const unsigned int MonomialBasisMaxOrder = 1024;
+
 
 
   // MonomialBasisSize
   // -----------------
 
+  namespace Impl
+  {
+    // whether a number of basis functions fits into an unsigned int
+    inline bool fitsMonomialBasisSize ( unsigned long long size )
+    {
+      return size <= std::numeric_limits< unsigned int >::max();
+    }
+  }
+
   template<>
   class MonomialBasisSize< Impl::Point >
   {
@@ -94,18 +122,18 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
       : maxOrder_( 0 ),
         sizes_( 0 ),
         numBaseFunctions_( 0 )
     {
-      computeSizes( 2 );
+      initialize( MonomialBasisMaxOrder );
     }
 
     ~MonomialBasisSize ()
@@ -124,15 +152,18 @@ namespace Dune
       return maxOrder_;
     }
 
+    //! the sizes are tabulated up to maxOrder(), throws a RangeError for higher orders
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
+      if( order > maxOrder_ )
+        DUNE_THROW( RangeError, "Order " << order << " of monomial basis exceeds the maximal order " << maxOrder_ );
+    }
 
+  private:
+    void initialize ( unsigned int order )
+    {
       maxOrder_ = order;
 
-      delete [] sizes_;
-      delete [] numBaseFunctions_;
       sizes_            = new unsigned int [ order+1 ];
       numBaseFunctions_ = new unsigned int [ order+1 ];
 
@@ -163,18 +194,18 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
       : maxOrder_( 0 ),
         sizes_( 0 ),
         numBaseFunctions_( 0 )
     {
-      computeSizes( 2 );
+      initialize( MonomialBasisMaxOrder );
     }
 
     ~MonomialBasisSize ()
@@ -193,21 +224,23 @@ namespace Dune
       return maxOrder_;
     }
 
+    //! the sizes are tabulated up to maxOrder(), throws a RangeError for higher orders
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
+      if( order > maxOrder_ )
+        DUNE_THROW( RangeError, "Order " << order << " of monomial basis exceeds the maximal order " << maxOrder_ );
+    }
 
+  private:
+    void initialize ( unsigned int order )
+    {
       maxOrder_ = order;
 
-      delete[] sizes_;
-      delete[] numBaseFunctions_;
       sizes_            = new unsigned int[ order+1 ];
       numBaseFunctions_ = new unsigned int[ order+1 ];
 
       MonomialBasisSize<BaseTopology> &baseBasis =
         MonomialBasisSize<BaseTopology>::instance();
-      baseBasis.computeSizes( order );
       const unsigned int *const baseSizes = baseBasis.sizes_;
       const unsigned int *const baseNBF   = baseBasis.numBaseFunctions_;
 
@@ -215,6 +248,13 @@ namespace Dune
       numBaseFunctions_[ 0 ] = 1;
       for( unsigned int k = 1; k <= order; ++k )
       {
+        // the tables end before the base table or the unsigned int ends
+        if( (k > baseBasis.maxOrder())
+            || !Impl::fitsMonomialBasisSize( numBaseFunctions_[ k-1 ] + baseNBF[ k ] + (unsigned long long)k*baseSizes[ k ] ) )
+        {
+          maxOrder_ = k-1;
+          return;
+        }
         sizes_[ k ]            = baseNBF[ k ] + k*baseSizes[ k ];
         numBaseFunctions_[ k ] = numBaseFunctions_[ k-1 ] + sizes_[ k ];
       }
@@ -238,18 +278,18 @@ namespace Dune
     friend class MonomialBasisSize< Impl::Prism< Topology > >;
     friend class MonomialBasisSize< Impl::Pyramid< Topology > >;
 
-    mutable unsigned int maxOrder_;
+    unsigned int maxOrder_;
     // sizes_[ k ]: number of basis functions of exactly order k
-    mutable unsigned int *sizes_;
+    unsigned int *sizes_;
     // numBaseFunctions_[ k ] = sizes_[ 0 ] + ... + sizes_[ k ]
-    mutable unsigned int *numBaseFunctions_;
+    unsigned int *numBaseFunctions_;
 
     MonomialBasisSize ()
       : maxOrder_( 0 ),
         sizes_( 0 ),
         numBaseFunctions_( 0 )
     {
-      computeSizes( 2 );
+      initialize( MonomialBasisMaxOrder );
     }
 
     ~MonomialBasisSize ()
@@ -268,28 +308,36 @@ namespace Dune
       return maxOrder_;
     }
 
+    //! the sizes are tabulated up to maxOrder(), throws a RangeError for higher orders
     void computeSizes ( unsigned int order ) const
     {
-      if (order <= maxOrder_)
-        return;
+      if( order > maxOrder_ )
+        DUNE_THROW( RangeError, "Order " << order << " of monomial basis exceeds the maximal order " << maxOrder_ );
+    }
 
+  private:
+    void initialize ( unsigned int order )
+    {
       maxOrder_ = order;
 
-      delete[] sizes_;
-      delete[] numBaseFunctions_;
       sizes_            = new unsigned int[ order+1 ];
       numBaseFunctions_ = new unsigned int[ order+1 ];
 
       MonomialBasisSize<BaseTopology> &baseBasis =
         MonomialBasisSize<BaseTopology>::instance();
 
-      baseBasis.computeSizes( order );
-
       const unsigned int *const baseNBF = baseBasis.numBaseFunctions_;
       sizes_[ 0 ] = 1;
       numBaseFunctions_[ 0 ] = 1;
       for( unsigned int k = 1; k <= order; ++k )
       {
+        // the tables end before the base table or the unsigned int ends
+        if( (k > baseBasis.maxOrder())
+            || !Impl::fitsMonomialBasisSize( (unsigned long long)numBaseFunctions_[ k-1 ] + baseNBF[ k ] ) )
+        {
+          maxOrder_ = k-1;
+          return;
+        }
         sizes_[ k ]            = baseNBF[ k ];
         numBaseFunctions_[ k ] = numBaseFunctions_[ k-1 ] + sizes_[ k ];
       }
@@ -628,6 +676,76 @@ namespace Dune
 
 
 
+  // IsMonomialTopology
+  // ------------------
+
+  /**
+   * \brief true if the monomial basis of the topology consists of the
+   *        monomials x^alpha, i.e., for all topologies except for pyramids
+   *        over a non-simplex base, whose basis is obtained by a Duffy
+   *        transform
+   **/
+  template< class Topology >
+  struct IsMonomialTopology;
+
+  template<>
+  struct IsMonomialTopology< Impl::Point >
+    : public std::true_type
+  {};
+
+  template< class BaseTopology >
+  struct IsMonomialTopology< Impl::Prism< BaseTopology > >
+    : public IsMonomialTopology< BaseTopology >
+  {};
+
+  template< class BaseTopology >
+  struct IsMonomialTopology< Impl::Pyramid< BaseTopology > >
+    : public std::integral_constant< bool, Impl::IsSimplex< Impl::Pyramid< BaseTopology > >::value >
+  {};
+
+
+
+  // MonomialDerivativeDirections
+  // ----------------------------
+
+  /**
+   * \brief the multi-indices of the partial derivatives of order deriv in
+   *        the order used by MonomialBasis::evaluate and
+   *        MonomialBasis::evaluatePartials, i.e., ordered by the exponent of
+   *        the last coordinate first
+   **/
+  template< unsigned int dim >
+  struct MonomialDerivativeDirections
+  {
+    typedef std::array< unsigned int, dim > Direction;
+
+    static void apply ( const unsigned int deriv, std::vector< Direction > &result )
+    {
+      Direction beta;
+      result.clear();
+      append( dim, deriv, beta, result );
+    }
+
+  private:
+    static void append ( const unsigned int d, const unsigned int deriv, Direction &beta,
+                         std::vector< Direction > &result )
+    {
+      if( d == 0 )
+      {
+        if( deriv == 0 )
+          result.push_back( beta );
+        return;
+      }
+      for( unsigned int k = 0; k <= deriv; ++k )
+      {
+        beta[ d-1 ] = k;
+        append( d-1, deriv-k, beta, result );
+      }
+    }
+  };
+
+
+
   // MonomialBasis
   // -------------
 
@@ -655,7 +773,7 @@ namespace Dune
         order_(order),
         size_(Size::instance())
     {
-      assert(order<=1024); // avoid wrapping of unsigned int (0-1) order=1024 is quite hight...)
+      size_.computeSizes( order );
     }
 
     const unsigned int *sizes ( unsigned int order ) const
@@ -682,6 +800,12 @@ namespace Dune
       return MonomialBasisSize< SimplexTopology >::instance() ( deriv );
     }
 
+    //! number of partial derivatives of exactly order deriv
+    unsigned int partialSize ( const unsigned int deriv ) const
+    {
+      return derivSize( deriv ) - (deriv > 0 ? derivSize( deriv-1 ) : 0);
+    }
+
     unsigned int order () const
     {
       return order_ ;
@@ -698,6 +822,36 @@ namespace Dune
       Base::evaluate( deriv, order_, x, derivSize( deriv ), sizes( order_ ), values );
     }
 
+    /** \brief evaluate the partial derivatives of order deriv only
+     *
+     *  Contrary to evaluate( deriv, x, values ), the values and the
+     *  derivatives of lower order are not returned. The partial derivatives
+     *  of monomial j are stored in values[ j*partialSize( deriv ) + k ] in
+     *  the order of the last partialSize( deriv ) entries of each block
+     *  filled by evaluate( deriv, x, values ), e.g., the gradient for
+     *  deriv = 1.
+     *
+     *  The derivatives of a monomial x^alpha are multiples of monomials of
+     *  lower order. They are obtained from the values of the monomials by
+     *  an index map, which is computed on first use.
+     */
+    void evaluatePartials ( const unsigned int deriv, const DomainVector &x,
+                            Field *const values ) const
+    {
+      evaluatePartials( deriv, x, values, std::integral_constant< bool, IsMonomialTopology< Topology >::value >() );
+    }
+
+    /** \brief evaluate the partial derivative given by a multi-index only
+     *
+     *  values[ j ] is the partial derivative of monomial j, where order[ i ]
+     *  is the number of derivatives with respect to x_i.
+     */
+    void evaluatePartial ( const std::array< unsigned int, dimension > &order, const DomainVector &x,
+                           Field *const values ) const
+    {
+      evaluatePartial( order, x, values, std::integral_constant< bool, IsMonomialTopology< Topology >::value >() );
+    }
+
     template <unsigned int deriv>
     void evaluate ( const DomainVector &x,
                     Field *const values ) const
@@ -751,10 +905,156 @@ namespace Dune
       integrate( &(values[ 0 ]) );
     }
   private:
+    typedef std::array< unsigned int, dimension > Direction;
+
+    // exponent[ j*dimension + i ]: exponent of x_i in monomial j
+    // lower[ j*dimension + i ]: index of monomial j divided by x_i
+    struct DerivativeMap
+    {
+      std::vector< unsigned int > exponent, lower;
+    };
+
+    const DerivativeMap &derivativeMap () const
+    {
+      std::call_once( derivativeMapFlag_, [ this ] () {
+          typedef MultiIndex< dimension, double > MI;
+          MonomialBasis< Topology, MI > basis( order_ );
+          std::vector< FieldVector< MI, 1 > > y( size() );
+          FieldVector< MI, dimension > x;
+          for( unsigned int i = 0; i < dimension; ++i )
+            x[ i ].set( i );
+          basis.evaluate( x, y );
+
+          std::map< Direction, unsigned int > index;
+          for( unsigned int j = 0; j < size(); ++j )
+          {
+            Direction alpha;
+            for( unsigned int i = 0; i < dimension; ++i )
+              alpha[ i ] = y[ j ][ 0 ].z( i );
+            index[ alpha ] = j;
+          }
+
+          derivativeMap_.exponent.resize( size()*dimension );
+          derivativeMap_.lower.resize( size()*dimension );
+          for( const auto &monomial : index )
+          {
+            Direction alpha = monomial.first;
+            for( unsigned int i = 0; i < dimension; ++i )
+            {
+              const unsigned int k = monomial.second*dimension + i;
+              derivativeMap_.exponent[ k ] = alpha[ i ];
+              derivativeMap_.lower[ k ] = monomial.second;
+              if( alpha[ i ] > 0 )
+              {
+                --alpha[ i ];
+                assert( index.count( alpha ) == 1 );
+                derivativeMap_.lower[ k ] = index[ alpha ];
+                ++alpha[ i ];
+              }
+            }
+          }
+        } );
+      return derivativeMap_;
+    }
+
+    // partial derivative beta of monomial j from the values of the monomials
+    static Field partial ( const DerivativeMap &map, const Direction &beta,
+                           const Field *const monomials, unsigned int j )
+    {
+      Field factor = Unity< Field >();
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        for( unsigned int k = 0; k < beta[ i ]; ++k )
+        {
+          const unsigned int alpha = map.exponent[ j*dimension + i ];
+          if( alpha == 0 )
+            return Zero< Field >();
+          factor *= Field( alpha );
+          j = map.lower[ j*dimension + i ];
+        }
+      }
+      return factor * monomials[ j ];
+    }
+
+    void evaluatePartials ( const unsigned int deriv, const DomainVector &x,
+                            Field *const values, std::true_type ) const
+    {
+      if( deriv == 0 )
+      {
+        evaluate( 0, x, values );
+        return;
+      }
+
+      const DerivativeMap &map = derivativeMap();
+      std::vector< Field > &monomials = scratch();
+      monomials.resize( size() );
+      evaluate( 0, x, monomials.data() );
+
+      std::vector< Direction > &betas = Impl::threadScratch< This, Direction >();
+      MonomialDerivativeDirections< dimension >::apply( deriv, betas );
+      Field *it = values;
+      for( unsigned int j = 0; j < size(); ++j )
+        for( const Direction &beta : betas )
+          *it++ = partial( map, beta, monomials.data(), j );
+    }
+
+    void evaluatePartial ( const Direction &beta, const DomainVector &x,
+                           Field *const values, std::true_type ) const
+    {
+      const DerivativeMap &map = derivativeMap();
+      std::vector< Field > &monomials = scratch();
+      monomials.resize( size() );
+      evaluate( 0, x, monomials.data() );
+      for( unsigned int j = 0; j < size(); ++j )
+        values[ j ] = partial( map, beta, monomials.data(), j );
+    }
+
+    // the basis functions are no monomials, so all derivatives up to the
+    // requested order are evaluated
+    void evaluatePartials ( const unsigned int deriv, const DomainVector &x,
+                            Field *const values, std::false_type ) const
+    {
+      const unsigned int block = derivSize( deriv );
+      const unsigned int first = block - partialSize( deriv );
+      std::vector< Field > &all = scratch();
+      all.resize( block*size() );
+      evaluate( deriv, x, all.data() );
+      Field *it = values;
+      for( unsigned int j = 0; j < size(); ++j )
+        for( unsigned int k = first; k < block; ++k )
+          *it++ = all[ j*block + k ];
+    }
+
+    void evaluatePartial ( const Direction &beta, const DomainVector &x,
+                           Field *const values, std::false_type ) const
+    {
+      unsigned int deriv = 0;
+      for( unsigned int i = 0; i < dimension; ++i )
+        deriv += beta[ i ];
+      std::vector< Direction > &betas = Impl::threadScratch< This, Direction >();
+      MonomialDerivativeDirections< dimension >::apply( deriv, betas );
+      const unsigned int k = std::find( betas.begin(), betas.end(), beta ) - betas.begin();
+
+      const unsigned int block = derivSize( deriv );
+      const unsigned int first = block - partialSize( deriv );
+      std::vector< Field > &all = scratch();
+      all.resize( block*size() );
+      evaluate( deriv, x, all.data() );
+      for( unsigned int j = 0; j < size(); ++j )
+        values[ j ] = all[ j*block + first + k ];
+    }
+
+    static std::vector< Field > &scratch ()
+    {
+      return Impl::threadScratch< This, Field >();
+    }
+
     MonomialBasis(const This&);
     This& operator=(const This&);
     unsigned int order_;
     Size &size_;
+    mutable std::once_flag derivativeMapFlag_;
+    mutable DerivativeMap derivativeMap_;
   };
 
 
@@ -841,8 +1141,24 @@ namespace Dune
       return topologyId_;
     }
 
+    //! number of partial derivatives of exactly order deriv
+    unsigned int partialSize ( const unsigned int deriv ) const
+    {
+      typedef MonomialBasisSize< typename Impl::SimplexTopology< dimension >::type > SimplexSize;
+      const SimplexSize &size = SimplexSize::instance();
+      return size( deriv ) - (deriv > 0 ? size( deriv-1 ) : 0);
+    }
+
     virtual void evaluate ( const unsigned int deriv, const DomainVector &x,
                             Field *const values ) const = 0;
+
+    //! \copydoc MonomialBasis::evaluatePartials
+    virtual void evaluatePartials ( const unsigned int deriv, const DomainVector &x,
+                                    Field *const values ) const = 0;
+
+    //! \copydoc MonomialBasis::evaluatePartial
+    virtual void evaluatePartial ( const std::array< unsigned int, dimension > &order, const DomainVector &x,
+                                   Field *const values ) const = 0;
     template < unsigned int deriv >
     void evaluate ( const DomainVector &x,
                     Field *const values ) const
@@ -929,6 +1245,18 @@ namespace Dune
       basis_.evaluate(deriv,x,values);
     }
 
+    void evaluatePartials ( const unsigned int deriv, const DomainVector &x,
+                            Field *const values ) const
+    {
+      basis_.evaluatePartials(deriv,x,values);
+    }
+
+    void evaluatePartial ( const std::array< unsigned int, Base::dimension > &order, const DomainVector &x,
+                           Field *const values ) const
+    {
+      basis_.evaluatePartial(order,x,values);
+    }
+
     void integrate ( Field *const values ) const
     {
       basis_.integrate(values);
@@ -983,17 +1311,76 @@ namespace Dune
   // MonomialBasisProvider
   // ---------------------
 
+  /**
+   * \brief A singleton container for the virtual monomial bases
+   *
+   * Each basis is created once per topology and order and lives until the
+   * end of the program. The objects are immutable, so the pointers handed
+   * out may be used from any thread. Unlike the TopologySingletonFactory,
+   * the storage is protected by a mutex, so that bases may be requested
+   * concurrently.
+   **/
   template< int dim, class SF >
   struct MonomialBasisProvider
-    : public TopologySingletonFactory< MonomialBasisFactory< dim, SF > >
   {
+    typedef MonomialBasisFactory< dim, SF > Factory;
+
     static const unsigned int dimension = dim;
     typedef SF StorageField;
+    typedef typename Factory::Key Key;
+    typedef typename Factory::Object Object;
+
     template < int dd, class FF >
     struct EvaluationBasisFactory
     {
       typedef MonomialBasisProvider<dd,FF> Type;
     };
+
+    static Object *create ( const Dune::GeometryType &gt, const Key &key )
+    {
+      return instance().getObject( gt.id(), key, [ &gt, &key ] () { return Factory::create( gt, key ); } );
+    }
+
+    template< class Topology >
+    static Object *create ( const Key &key )
+    {
+      return instance().getObject( Topology::id, key, [ &key ] () { return Factory::template create< Topology >( key ); } );
+    }
+
+    static void release ( Object *object )
+    {}
+
+  private:
+    struct ObjectDeleter
+    {
+      void operator() ( Object *object ) const
+      {
+        Factory::release( object );
+      }
+    };
+
+    typedef std::map< std::pair< unsigned int, Key >, std::unique_ptr< Object, ObjectDeleter > > Storage;
+
+    MonomialBasisProvider () = default;
+
+    static MonomialBasisProvider &instance ()
+    {
+      static MonomialBasisProvider provider;
+      return provider;
+    }
+
+    template< class Create >
+    Object *getObject ( unsigned int topologyId, const Key &key, const Create &create )
+    {
+      std::lock_guard< std::mutex > guard( mutex_ );
+      std::unique_ptr< Object, ObjectDeleter > &object = storage_[ std::make_pair( topologyId, key ) ];
+      if( !object )
+        object.reset( create() );
+      return object.get();
+    }
+
+    std::mutex mutex_;
+    Storage storage_;
   };
 
 }
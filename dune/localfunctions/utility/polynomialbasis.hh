@@ -3,8 +3,15 @@
 #ifndef DUNE_POLYNOMIALBASIS_HH
 #define DUNE_POLYNOMIALBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <fstream>
 #include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <dune/common/fmatrix.hh>
 
@@ -35,7 +42,7 @@ namespace Dune
    * the underlying basis and the coefficient matrix.
    * A specialization holding an instance
    * of the coefficient matrix is provided by the class
-   * template< class Eval, class CM = SparseCoeffMatrix<typename Eval::Field,Eval::dimRange> >
+   * template< class Eval, class CM = AdaptiveCoeffMatrix<typename Eval::Field,Eval::dimRange> >
    * class PolynomialBasisWithMatrix;
    *
    * \tparam B Basis set with
@@ -126,7 +133,59 @@ namespace Dune
       jacobian(x,out);
     }
 
-    //! \brief Evaluate partial derivatives of all shape functions
+    /** \brief Evaluate all shape functions at a set of points
+     *
+     *  The values for points[q] are written directly into
+     *  out[q*size()],...,out[(q+1)*size()-1].
+     */
+    template< class Points >
+    void evaluateFunctionBatch ( const Points &points,
+                                 std::vector<typename Traits::RangeType>& out ) const
+    {
+      out.resize(points.size()*size());
+      evaluateBatch<0>( points, out );
+    }
+
+    //! \brief Evaluate Jacobian of all shape functions at a set of points
+    template< class Points >
+    void evaluateJacobianBatch ( const Points &points,
+                                 std::vector<typename Traits::JacobianType>& out ) const
+    {
+      out.resize(points.size()*size());
+      jacobianBatch( points, out, std::integral_constant< bool, Evaluator::dimRange == 1 >() );
+    }
+
+    /** \brief Evaluate all shape functions and their derivatives up to
+     *         order deriv at a set of points
+     *
+     *  The monomials at all points are collected into one matrix with one
+     *  row per monomial, which is multiplied by the coefficient matrix in a
+     *  single matrix-matrix product instead of one matrix-vector product per
+     *  point. The result for points[q] and shape function i, as computed by
+     *  evaluate<deriv>, is written to values[q*size()+i].
+     */
+    template< unsigned int deriv, class Points, class RVector >
+    void evaluateBatch ( const Points &points, RVector &values ) const
+    {
+      typedef typename RVector::value_type YDerivatives;
+      typedef typename Evaluator::template Iterator< deriv >::All::Derivatives XDerivatives;
+      assert( values.size() >= points.size()*size() );
+      XDerivatives val;
+      multPoints( points, XDerivatives::size,
+                  [ this ] ( const DomainVector &x, typename XDerivatives::Field *single ) {
+          basis_.template evaluate< deriv >( x, single );
+        },
+                  [ &values, &val, this ] ( std::size_t q, unsigned int i, unsigned int r, const typename XDerivatives::Field *y ) {
+          std::copy( y, y + XDerivatives::size, &(val.block()[ 0 ]) );
+          DerivativeAssign< XDerivatives, YDerivatives >::apply( r, val, values[ q*size() + i ] );
+        } );
+    }
+
+    /** \brief Evaluate partial derivatives of all shape functions
+     *
+     *  For a scalar underlying basis, only the requested partial derivative
+     *  of the monomials is evaluated and multiplied by the coefficients.
+     */
     void partial (const std::array<unsigned int, dimension>& order,
                   const typename Traits::DomainType& in,         // position
                   std::vector<typename Traits::RangeType>& out) const      // return value
@@ -135,14 +194,28 @@ namespace Dune
       if (totalOrder == 0) {
         evaluateFunction(in, out);
       } else {
-        DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+        partial(order, in, out, std::integral_constant< bool, Evaluator::dimRange == 1 >());
       }
     }
 
+    /** \brief Evaluate the second derivatives of all shape functions
+     *
+     *  For a scalar underlying basis, the second partial derivatives of the
+     *  monomials are evaluated once and multiplied by the coefficients in a
+     *  single matrix product.
+     */
+    template< class Out >
+    void evaluateHessian (const typename Traits::DomainType& in,
+                          Out& out) const
+    {
+      Impl::resizeOutput(out, size());
+      hessian(in, out, std::integral_constant< bool, Evaluator::dimRange == 1 >());
+    }
+
     template< unsigned int deriv, class F >
     void evaluate ( const DomainVector &x, F *values ) const
     {
-      coeffMatrix_->mult( eval_.template evaluate<deriv>( x ), size(), values);
+      coeffMatrix_->mult( eval_.template evaluate<deriv>( x, scratch() ), size(), values);
     }
     template< unsigned int deriv, class DVector, class F >
     void evaluate ( const DVector &x, F *values ) const
@@ -179,7 +252,7 @@ namespace Dune
     {
       assert(values.size()>=size());
       const DomainVector &bx = Convert<true,DVector>::apply(x);
-      coeffMatrix_->mult( eval_.template evaluate<deriv>( bx ), values );
+      coeffMatrix_->mult( eval_.template evaluate<deriv>( bx, scratch() ), values );
     }
 
     template <class Fy>
@@ -201,7 +274,7 @@ namespace Dune
     void evaluateSingle ( const DomainVector &x, Vector &values ) const
     {
       assert(values.size()>=size());
-      coeffMatrix_->template mult<deriv>( eval_.template evaluate<deriv>( x ), values );
+      coeffMatrix_->template mult<deriv>( eval_.template evaluate<deriv>( x, scratch() ), values );
     }
     template< unsigned int deriv, class Fy >
     void evaluateSingle ( const DomainVector &x,
@@ -220,7 +293,7 @@ namespace Dune
     void jacobian ( const DomainVector &x, std::vector<FieldMatrix<Fy,dimRange,dimension> > &values ) const
     {
       assert(values.size()>=size());
-      evaluateSingle<1>(x,reinterpret_cast<std::vector<FieldVector<Fy,dimRange*dimension> >&>(values));
+      jacobian( x, values, std::integral_constant< bool, Evaluator::dimRange == 1 >() );
     }
     template< class DVector, class RVector >
     void jacobian ( const DVector &x, RVector &values ) const
@@ -236,10 +309,212 @@ namespace Dune
     void integrate ( std::vector<Fy> &values ) const
     {
       assert(values.size()>=size());
-      coeffMatrix_->mult( eval_.template integrate(), values );
+      coeffMatrix_->mult( eval_.integrate( scratch() ), values );
     }
 
   protected:
+    // number of points evaluated in one matrix-matrix product
+    static const std::size_t batchSize = 64;
+
+    // evaluate the monomials at all points, multiply them by the coefficient
+    // matrix, and call assign( q, i, r, y ) with the numComp derivatives y of
+    // component block r of shape function i at point q; the underlying basis
+    // is evaluated by evaluate( x, single ), which stores numComp derivatives
+    // per monomial
+    template< class Points, class Evaluate, class Assign >
+    void multPoints ( const Points &points, std::size_t numComp, Evaluate &&evaluate, Assign &&assign ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      static const unsigned int blockSize = CoefficientMatrix::blockSize;
+
+      // hierarchical bases may share a coefficient matrix of higher order
+      const unsigned int numBase = std::min( coeffMatrix_->baseSize(), basis_.size() );
+      const unsigned int numRows = size()*blockSize;
+
+      std::vector< XField > single( numComp*basis_.size() );
+      std::vector< XField > x( std::size_t( numBase )*batchSize*numComp );
+      std::vector< XField > y( std::size_t( numRows )*batchSize*numComp );
+      DomainVector bx;
+      for( std::size_t q0 = 0; q0 < points.size(); q0 += batchSize )
+      {
+        const std::size_t nq = std::min( std::size_t( batchSize ), points.size() - q0 );
+        const std::size_t n = nq*numComp;
+
+        // monomials-by-points matrix, one row per monomial
+        for( std::size_t q = 0; q < nq; ++q )
+        {
+          for( unsigned int d = 0; d < dimension; ++d )
+            field_cast( points[ q0+q ][ d ], bx[ d ] );
+          evaluate( bx, single.data() );
+          for( unsigned int j = 0; j < numBase; ++j )
+            std::copy( single.begin() + j*numComp, single.begin() + (j+1)*numComp,
+                       x.begin() + j*n + q*numComp );
+        }
+
+        coeffMatrix_->multMatrix( x.data(), numBase, n, numRows, y.data() );
+
+        for( std::size_t q = 0; q < nq; ++q )
+          for( unsigned int i = 0; i < size(); ++i )
+            for( unsigned int r = 0; r < blockSize; ++r )
+              assign( q0+q, i, r, y.data() + (i*blockSize + r)*n + q*numComp );
+      }
+    }
+
+    // Jacobians for a scalar underlying basis: only the gradients of the
+    // monomials are evaluated and multiplied
+    template< class Points, class Out >
+    void jacobianBatch ( const Points &points, Out &out, std::true_type ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      multPoints( points, dimension,
+                  [ this ] ( const DomainVector &x, XField *single ) {
+          basis_.evaluatePartials( 1, x, single );
+        },
+                  [ &out, this ] ( std::size_t q, unsigned int i, unsigned int r, const XField *y ) {
+          for( unsigned int d = 0; d < dimension; ++d )
+            field_cast( y[ d ], out[ q*size() + i ][ r ][ d ] );
+        } );
+    }
+
+    // Jacobians for a vector-valued underlying basis
+    template< class Points, class Out >
+    void jacobianBatch ( const Points &points, Out &out, std::false_type ) const
+    {
+      typedef FieldVector< R, dimRange*dimension > FlatJacobian;
+      typedef typename Evaluator::template Iterator< 1 >::All::Derivatives XDerivatives;
+      typedef typename XDerivatives::Field XField;
+      typedef FieldVector< XField, FlatJacobian::dimension > XLFETensor;
+      XDerivatives val;
+      XLFETensor tensor;
+      multPoints( points, XDerivatives::size,
+                  [ this ] ( const DomainVector &x, XField *single ) {
+          basis_.template evaluate< 1 >( x, single );
+        },
+                  [ &out, &val, &tensor, this ] ( std::size_t q, unsigned int i, unsigned int r, const XField *y ) {
+          std::copy( y, y + XDerivatives::size, &(val.block()[ 0 ]) );
+          if( r == 0 )
+            tensor = XField( 0 );
+          LFETensorAxpy< XDerivatives, XLFETensor, 1 >::apply( r, XField( 1 ), val, tensor );
+          if( r+1 == CoefficientMatrix::blockSize )
+            field_cast( tensor, reinterpret_cast< FlatJacobian & >( out[ q*size() + i ] ) );
+        } );
+    }
+
+    // multiply the numComp derivatives of each monomial stored in the first
+    // part of the scratch storage by the coefficient matrix; returns the
+    // derivatives of component block r of shape function i, starting at
+    // (i*blockSize + r)*numComp
+    template< class Evaluate >
+    const typename Evaluator::Container::value_type *
+    multSingle ( std::size_t numComp, Evaluate &&evaluate ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      const unsigned int numBase = std::min( coeffMatrix_->baseSize(), basis_.size() );
+      const unsigned int numRows = size()*CoefficientMatrix::blockSize;
+
+      typename Evaluator::Container &container = scratch();
+      container.resize( (basis_.size() + numRows)*numComp );
+      XField *const x = container.data();
+      XField *const y = x + basis_.size()*numComp;
+      evaluate( x );
+      coeffMatrix_->multMatrix( x, numBase, numComp, numRows, y );
+      return y;
+    }
+
+    // Jacobian for a scalar underlying basis: only the gradients of the
+    // monomials are evaluated and multiplied
+    template< class Fy >
+    void jacobian ( const DomainVector &x, std::vector< FieldMatrix< Fy, dimRange, dimension > > &values,
+                    std::true_type ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      const XField *y = multSingle( dimension, [ this, &x ] ( XField *single ) {
+          basis_.evaluatePartials( 1, x, single );
+        } );
+      for( unsigned int i = 0; i < size(); ++i )
+        for( unsigned int r = 0; r < dimRange; ++r, y += dimension )
+          for( unsigned int d = 0; d < dimension; ++d )
+            field_cast( y[ d ], values[ i ][ r ][ d ] );
+    }
+
+    template< class Fy >
+    void jacobian ( const DomainVector &x, std::vector< FieldMatrix< Fy, dimRange, dimension > > &values,
+                    std::false_type ) const
+    {
+      evaluateSingle<1>(x,reinterpret_cast<std::vector<FieldVector<Fy,dimRange*dimension> >&>(values));
+    }
+
+    void partial ( const std::array< unsigned int, dimension > &order,
+                   const typename Traits::DomainType &in,
+                   std::vector< typename Traits::RangeType > &out, std::true_type ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      const DomainVector &x = Convert< true, typename Traits::DomainType >::apply( in );
+      const XField *y = multSingle( 1, [ this, &order, &x ] ( XField *single ) {
+          basis_.evaluatePartial( order, x, single );
+        } );
+      out.resize( size() );
+      for( unsigned int i = 0; i < size(); ++i )
+        for( unsigned int r = 0; r < dimRange; ++r, ++y )
+          field_cast( *y, out[ i ][ r ] );
+    }
+
+    void partial ( const std::array< unsigned int, dimension > &order,
+                   const typename Traits::DomainType &in,
+                   std::vector< typename Traits::RangeType > &out, std::false_type ) const
+    {
+      DUNE_THROW(NotImplemented, "Desired derivative order is not implemented");
+    }
+
+    template< class Out >
+    void hessian ( const typename Traits::DomainType &in, Out &out, std::true_type ) const
+    {
+      typedef typename Evaluator::Container::value_type XField;
+      typedef std::array< unsigned int, dimension > Direction;
+      const DomainVector &x = Convert< true, typename Traits::DomainType >::apply( in );
+
+      // the second derivatives in the order of evaluatePartials and the
+      // entries (a,b) of the Hessian they belong to
+      std::vector< Direction > &betas = Impl::threadScratch< This, Direction >();
+      MonomialDerivativeDirections< dimension >::apply( 2, betas );
+      const unsigned int numComp = betas.size();
+      assert( numComp == dimension*(dimension+1)/2 );
+      std::array< std::pair< unsigned int, unsigned int >, dimension*(dimension+1)/2 > entries;
+      for( unsigned int k = 0; k < numComp; ++k )
+      {
+        const Direction &beta = betas[ k ];
+        const unsigned int a = std::find_if( beta.begin(), beta.end(), [] ( unsigned int e ) { return e > 0; } ) - beta.begin();
+        const unsigned int b = (beta[ a ] == 2) ? a : std::find_if( beta.begin()+a+1, beta.end(), [] ( unsigned int e ) { return e > 0; } ) - beta.begin();
+        entries[ k ] = std::make_pair( a, b );
+      }
+
+      const XField *y = multSingle( numComp, [ this, &x ] ( XField *single ) {
+          basis_.evaluatePartials( 2, x, single );
+        } );
+
+      for( unsigned int i = 0; i < size(); ++i )
+        for( unsigned int r = 0; r < dimRange; ++r, y += numComp )
+          for( unsigned int k = 0; k < numComp; ++k )
+          {
+            const unsigned int a = entries[ k ].first, b = entries[ k ].second;
+            field_cast( y[ k ], out[ i ][ r ][ a ][ b ] );
+            out[ i ][ r ][ b ][ a ] = out[ i ][ r ][ a ][ b ];
+          }
+    }
+
+    template< class Out >
+    void hessian ( const typename Traits::DomainType &in, Out &out, std::false_type ) const
+    {
+      DUNE_THROW(NotImplemented, "Hessians of vector-valued bases are not implemented");
+    }
+
+    // storage for the evaluated underlying basis; it is separate for each
+    // thread, so that the const evaluation methods can be called concurrently
+    static typename Evaluator::Container &scratch ()
+    {
+      return Impl::threadScratch< This, typename Evaluator::Container::value_type >();
+    }
+
     PolynomialBasis(const PolynomialBasis &other)
       : basis_(other.basis_),
         coeffMatrix_(other.coeffMatrix_),
@@ -250,7 +525,7 @@ namespace Dune
     PolynomialBasis &operator=(const PolynomialBasis&);
     const Basis &basis_;
     const CoefficientMatrix* coeffMatrix_;
-    mutable Evaluator eval_;
+    Evaluator eval_;
     unsigned int order_,size_;
   };
 
@@ -258,9 +533,10 @@ namespace Dune
    * Specialized version of PolynomialBasis with FieldMatrix for matrix
    * coefficience and std::vector for container type with FieldVector as
    * value type. This class stores the coefficient matrix with can be
-   * constructed via the fill method
+   * constructed via the fill method. By default, the coefficient matrix
+   * chooses dense or sparse storage from the fill ratio of the matrix.
    */
-  template< class Eval, class CM = SparseCoeffMatrix<typename Eval::Field,Eval::dimRange>,
+  template< class Eval, class CM = AdaptiveCoeffMatrix<typename Eval::Field,Eval::dimRange>,
       class D=double, class R=double>
   class PolynomialBasisWithMatrix
     : public PolynomialBasis< Eval, CM, D, R >